@@ -0,0 +1,246 @@
+#pragma once
+
+/**
+ * @file BufferLease.hpp
+ * @brief Defines BufferLease, a receive buffer kept from the ring after the
+ * receive callback returned.
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace iuring
+{
+class BufferLeaseQueue;
+
+/** a receive buffer of a buffer group, by group id and buffer id */
+struct LeasedBuffer
+{
+    uint16_t m_group;
+    unsigned m_idx;
+};
+
+class BufferHold;
+
+/** A receive buffer, or a part of it, a callback took with
+ * ReceivedMessage::take_lease(). The ring does not reuse the buffer until
+ * every lease on it is released or destroyed, which may happen on any
+ * thread. The data is only valid as long as the ring lives.
+ */
+class BufferLease
+{
+public:
+    BufferLease() = default;
+    BufferLease(const BufferLease&) = delete;
+    BufferLease& operator=(const BufferLease&) = delete;
+
+    BufferLease(BufferLease&& other) noexcept
+        : m_hold(std::move(other.m_hold))
+        , m_data(other.m_data)
+        , m_size(other.m_size)
+    {
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+
+    BufferLease& operator=(BufferLease&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            m_hold = std::move(other.m_hold);
+            m_data = other.m_data;
+            m_size = other.m_size;
+            other.m_data = nullptr;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    ~BufferLease()
+    {
+        release();
+    }
+
+    /** the data is gone after this, the buffer goes back to the ring with
+     * the last lease on it
+     */
+    void release()
+    {
+        m_hold.reset();
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    bool is_valid() const
+    {
+        return m_hold != nullptr;
+    }
+
+    const uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    std::span<const uint8_t> get_span() const
+    {
+        return { m_data, m_size };
+    }
+
+private:
+    std::shared_ptr<BufferHold> m_hold;
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+
+    BufferLease(
+        std::shared_ptr<BufferHold> hold, const uint8_t* data, size_t size)
+        : m_hold(std::move(hold))
+        , m_data(data)
+        , m_size(size)
+    {
+    }
+
+    friend struct LeasableBuffer;
+};
+
+/** The ring's side of the leases: lets up to a maximum of buffers be held
+ * and collects the released ones, which the ring recycles when it polls.
+ */
+class BufferLeaseQueue : public std::enable_shared_from_this<BufferLeaseQueue>
+{
+public:
+    explicit BufferLeaseQueue(size_t max_leases)
+        : m_max_leases(max_leases)
+    {
+    }
+
+    /** @return nullptr if max_leases buffers are held already */
+    inline std::shared_ptr<BufferHold> hold(const LeasedBuffer& buffer);
+
+    /** replaces the contents of 'out' with the released buffers */
+    void take_released(std::vector<LeasedBuffer>& out)
+    {
+        out.clear();
+        std::lock_guard lock(m_mutex);
+        out.swap(m_released);
+    }
+
+    /** buffers held by leases and not yet released */
+    size_t outstanding() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_outstanding;
+    }
+
+    /** how often a lease found max_leases buffers in use */
+    uint64_t refused() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_refused;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    const size_t m_max_leases;
+    size_t m_outstanding = 0;
+    uint64_t m_refused = 0;
+    std::vector<LeasedBuffer> m_released;
+
+    void give_back(const LeasedBuffer& buffer)
+    {
+        std::lock_guard lock(m_mutex);
+        assert(m_outstanding > 0);
+        m_outstanding--;
+        m_released.push_back(buffer);
+    }
+
+    friend class BufferHold;
+};
+
+/** keeps one buffer from the ring for all leases on (parts of) it */
+class BufferHold
+{
+public:
+    BufferHold(std::shared_ptr<BufferLeaseQueue> queue, const LeasedBuffer& buffer)
+        : m_queue(std::move(queue))
+        , m_buffer(buffer)
+    {
+    }
+
+    BufferHold(const BufferHold&) = delete;
+    BufferHold& operator=(const BufferHold&) = delete;
+
+    ~BufferHold()
+    {
+        m_queue->give_back(m_buffer);
+    }
+
+private:
+    std::shared_ptr<BufferLeaseQueue> m_queue;
+    LeasedBuffer m_buffer;
+};
+
+
+std::shared_ptr<BufferHold> BufferLeaseQueue::hold(const LeasedBuffer& buffer)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_outstanding >= m_max_leases)
+        {
+            m_refused++;
+            return nullptr;
+        }
+        m_outstanding++;
+    }
+    return std::make_shared<BufferHold>(shared_from_this(), buffer);
+}
+
+/** A receive buffer that ReceivedMessage::take_lease() may keep, set up by
+ * the ring for every buffer it hands to a callback. The messages of one
+ * buffer (e.g. GRO segments) share it, each lease holds the buffer.
+ */
+struct LeasableBuffer
+{
+    BufferLeaseQueue* m_queue = nullptr;
+    LeasedBuffer m_buffer{};
+    /** set by the first lease: the ring must not recycle the buffer */
+    bool m_leased = false;
+    /** the ring's reference until the callback returned, so that a lease
+     * released during the callback doesn't give the buffer back early
+     */
+    std::shared_ptr<BufferHold> m_hold = nullptr;
+
+    /** @return std::nullopt if the buffer can't be leased or max_leases
+     * buffers are held already
+     */
+    std::optional<BufferLease> lease(const uint8_t* data, size_t size)
+    {
+        if (!m_queue)
+        {
+            return std::nullopt;
+        }
+        if (!m_hold)
+        {
+            m_hold = m_queue->hold(m_buffer);
+            if (!m_hold)
+            {
+                return std::nullopt;
+            }
+            m_leased = true;
+        }
+        return BufferLease(m_hold, data, size);
+    }
+};
+
+} // namespace iuring
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
 
 /**
@@ -14,13 +19,39 @@ enum class [[nodiscard]] ReceivePostAction{ NONE, RE_SUBMIT };
 
 struct AcceptResult
 {
+    /** -1 when the connection was accepted directly into m_fixed_slot */
     int m_new_fd;
     IPAddress m_address;
+    std::optional<unsigned> m_fixed_slot = std::nullopt;
 };
 
 struct SendResult
 {
     int status;
+    /** the id its TxTimestamp will have, for datagrams sent with
+     * DatagramSendParameters::tx_timestamp
+     */
+    std::optional<uint32_t> m_tx_timestamp_id = std::nullopt;
+    /** ids are only unique within a generation, see TxTimestamp */
+    uint32_t m_tx_timestamp_generation = 0;
+};
+
+/** when a packet sent with DatagramSendParameters::tx_timestamp left the
+ * stack
+ */
+struct TxTimestamp
+{
+    /** SendResult::m_tx_timestamp_id of the packet */
+    uint32_t m_id;
+    /** Kernels without SCM_TS_OPT_ID (< 6.13) count the ids themselves and
+     * a failed send puts the count out of step. The socket then restarts it
+     * in a new generation: only pair a timestamp with a SendResult of the
+     * same generation. Sends in flight during the restart may still pair
+     * wrongly, so on such kernels the ids are best effort.
+     */
+    uint32_t m_generation;
+    /** CLOCK_REALTIME since the epoch */
+    std::chrono::nanoseconds m_timestamp;
 };
 
 struct ConnectResult
@@ -34,13 +65,40 @@ struct CloseResult
     int status;
 };
 
+struct BackpressureStatus
+{
+    /** true: slow down, false: the overflow queue drained again */
+    bool congested;
+    /** work items waiting for SQ space */
+    size_t pending;
+};
+
+/** A small message for another ring, see IOUringInterface::post_to_ring()
+ */
+struct RingMessage
+{
+    uint32_t m_type;
+    /** only the lower 62 bits are available */
+    uint64_t m_value;
+};
+
 class ReceivedMessage;
+class ISocket;
 
 using recv_callback_func_t =
     std::function<ReceivePostAction(const ReceivedMessage& msg)>;
 
+/** gets every message of one completion, see
+ * IOUringInterface::submit_recv_bundle()
+ */
+using recv_batch_callback_func_t =
+    std::function<ReceivePostAction(std::span<const ReceivedMessage> msgs)>;
+
 using send_callback_func_t = std::function<void(const SendResult&)>;
 
+using tx_timestamp_callback_func_t =
+    std::function<void(const TxTimestamp& timestamp)>;
+
 using accept_callback_func_t =
     std::function<void(const AcceptResult& new_conn)>;
 
@@ -49,4 +107,13 @@ using connect_callback_func_t =
 
 using close_callback_func_t = std::function<void(const CloseResult& result)>;
 
+using backpressure_callback_func_t =
+    std::function<void(const BackpressureStatus& status)>;
+
+using ring_message_callback_func_t =
+    std::function<void(const RingMessage& msg)>;
+
+using socket_handoff_callback_func_t =
+    std::function<void(const std::shared_ptr<ISocket>& socket)>;
+
 } // namespace iuring
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+/**
+ * @file HybridPoller.hpp
+ * @brief Defines the HybridPoller, an event loop step that busy-polls
+ * during bursts and sleeps in the kernel in between.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+
+#include <slogger/Error.hpp>
+
+#include "IOUringInterface.hpp"
+
+namespace iuring
+{
+struct HybridPollerConfig
+{
+    /** the spin window never gets shorter than this */
+    std::chrono::microseconds min_spin{ 5 };
+
+    /** if bursts are further apart than this, spinning won't catch them
+     * and we only spin for min_spin.
+     */
+    std::chrono::microseconds max_spin{ 200 };
+
+    /** spin window used until we have seen two completions */
+    std::chrono::microseconds initial_spin{ 50 };
+
+    /** the spin window is this many times the average inter-arrival time */
+    double inter_arrival_factor = 2.0;
+
+    /** upper bound of a single sleep in the kernel */
+    std::chrono::microseconds sleep_timeout{ 100'000 };
+};
+
+struct HybridPollerStats
+{
+    /** run_once() calls that found completions while spinning */
+    uint64_t spin_hits = 0;
+
+    /** run_once() calls that found completions after sleeping */
+    uint64_t sleep_wakeups = 0;
+
+    /** sleeps that ended without any completion */
+    uint64_t sleep_timeouts = 0;
+
+    /** time spent spinning without finding a completion */
+    std::chrono::nanoseconds wasted_spin_time{ 0 };
+
+    /** the current (adapted) spin window */
+    std::chrono::nanoseconds spin_window{ 0 };
+};
+
+/** Busy-polls the completion queue for a while after the last
+ * completion, then falls back to blocking in the kernel.
+ *
+ * Typical use:
+ *      HybridPoller poller(io);
+ *      while (!should_quit) {
+ *          poller.run_once();
+ *      }
+ */
+class HybridPoller
+{
+public:
+    explicit HybridPoller(const std::shared_ptr<IOUringInterface>& io,
+        const HybridPollerConfig& config = {});
+
+    /** @return the number of completions handled, 0 on timeout. */
+    std::expected<size_t, error::Error> run_once();
+
+    const HybridPollerStats& get_stats() const
+    {
+        return m_stats;
+    }
+
+    void reset_stats();
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    std::shared_ptr<IOUringInterface> m_io;
+    HybridPollerConfig m_config;
+    HybridPollerStats m_stats;
+
+    std::optional<clock::time_point> m_last_completion;
+    std::optional<std::chrono::nanoseconds> m_avg_inter_arrival;
+    std::chrono::nanoseconds m_spin_window;
+
+    void record_completion(clock::time_point now);
+};
+
+} // namespace iuring
@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * @file IOUringCapabilities.hpp
+ * @brief Defines what the running kernel's io_uring supports, as found
+ * during init().
+ */
+
+#include <bitset>
+#include <cstdint>
+
+#include "UringDefs.hpp"
+
+namespace iuring
+{
+enum class Capability
+{
+    /** IORING_FEAT_NODROP: CQ overflows don't lose completions */
+    NODROP,
+    /** IORING_FEAT_FAST_POLL: no worker threads for socket readiness */
+    FAST_POLL,
+    /** IORING_FEAT_EXT_ARG: waits with a timeout don't need a timeout SQE */
+    EXT_ARG,
+    /** IORING_FEAT_RECVSEND_BUNDLE: one receive can fill several buffers */
+    RECVSEND_BUNDLE,
+
+    MSG_RING,
+    /** zero-copy sends, also from registered buffers */
+    SEND_ZC,
+    /** multishot accept, buffer rings, sparse file tables, accept_direct
+     * (kernel 5.19)
+     */
+    MULTISHOT_ACCEPT,
+    /** multishot recv and recvmsg (kernel 6.0) */
+    MULTISHOT_RECV,
+    REGISTERED_BUFFERS,
+
+    /** number of entries, keep last */
+    COUNT
+};
+
+/** Filled once during init() from io_uring_params.features and the
+ * opcode probe. Optional fast paths check it instead of finding out the
+ * hard way.
+ */
+class IOUringCapabilities
+{
+public:
+    bool has(Capability cap) const
+    {
+        return m_capabilities.test(static_cast<size_t>(cap));
+    }
+
+    /** @return true if the kernel knows the opcode */
+    bool supports(UringFeature op) const
+    {
+        return m_ops.test(static_cast<size_t>(op));
+    }
+
+    /** the raw io_uring_params.features bits */
+    uint32_t get_feature_bits() const
+    {
+        return m_feature_bits;
+    }
+
+    void set(Capability cap, bool value = true)
+    {
+        m_capabilities.set(static_cast<size_t>(cap), value);
+    }
+
+    void set_supported(UringFeature op)
+    {
+        m_ops.set(static_cast<size_t>(op));
+    }
+
+    void set_feature_bits(uint32_t bits)
+    {
+        m_feature_bits = bits;
+    }
+
+private:
+    std::bitset<static_cast<size_t>(Capability::COUNT)> m_capabilities;
+    std::bitset<static_cast<size_t>(UringFeature::COUNT)> m_ops;
+    uint32_t m_feature_bits = 0;
+};
+
+} // namespace iuring
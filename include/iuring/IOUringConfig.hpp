@@ -0,0 +1,181 @@
+#pragma once
+
+/**
+ * @file IOUringConfig.hpp
+ * @brief Defines the runtime settings used to set up the io_uring instance.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace iuring
+{
+static constexpr size_t DEFAULT_QUEUE_SIZE = 64;
+
+/** how the memory of the receive buffer rings and the send arena is
+ * allocated
+ */
+struct RingMemoryConfig
+{
+    /** MAP_HUGETLB if the system has huge pages reserved, transparent huge
+     * pages (MADV_HUGEPAGE) otherwise
+     */
+    bool huge_pages = false;
+
+    /** place the memory on the NUMA node of the CPU that maps it, i.e. the
+     * thread calling init() (the pinned ring thread of an IOUringGroup)
+     */
+    bool numa_local = false;
+
+    /** fault in every page up front, not on the first receive/send */
+    bool prefault = true;
+};
+
+/** one size class of receive buffers */
+struct BufferGroupConfig
+{
+    size_t buffer_size = 4096;
+
+    /** number of buffers, a power of 2 (max 32768) */
+    unsigned count = 1024;
+
+    /** IOU_PBUF_RING_INC: stream receives fill a buffer bit by bit instead
+     * of using up a whole buffer per receive. Meant for large buffers on
+     * chatty TCP connections. Falls back to whole buffers on kernels < 6.12.
+     */
+    bool incremental = false;
+};
+
+/** Selects the io_uring setup flags at runtime.
+ *
+ * The setup flags default to the plain io_uring_queue_init() behavior, and
+ * sends are plain sends. Modes the running kernel rejects are switched off again during init(),
+ * IOUringInterface::get_active_config() reports what is actually in use.
+ */
+struct IOUringConfig
+{
+    /** number of submission queue entries */
+    size_t queue_size = DEFAULT_QUEUE_SIZE;
+
+    /** number of completion queue entries (IORING_SETUP_CQSIZE).
+     * 0 keeps the kernel default of 2 * queue_size.
+     */
+    size_t cq_entries = 0;
+
+    /** IORING_SETUP_SUBMIT_ALL: keep submitting after a bad SQE */
+    bool submit_all = false;
+
+    /** IORING_SETUP_COOP_TASKRUN: no IPIs to run completion work */
+    bool coop_taskrun = false;
+
+    /** IORING_SETUP_SINGLE_ISSUER: only the thread that calls init()
+     * submits to the ring.
+     */
+    bool single_issuer = false;
+
+    /** IORING_SETUP_DEFER_TASKRUN: completion work only runs when we poll.
+     * Implies single_issuer.
+     */
+    bool defer_taskrun = false;
+
+    /** IORING_SETUP_SQPOLL: a kernel thread picks up submissions.
+     * Not combinable with coop_taskrun or defer_taskrun.
+     */
+    bool sqpoll = false;
+
+    /** pins the SQPOLL thread to this CPU (IORING_SETUP_SQ_AFF) */
+    std::optional<int> sq_thread_cpu;
+
+    /** how long the SQPOLL thread spins before it sleeps, 0 = kernel default
+     */
+    uint32_t sq_thread_idle_ms = 0;
+
+    /** io_uring_register_ring_fd(): saves the fd lookup on every enter */
+    bool register_ring_fd = false;
+
+    /** Don't enter the kernel for every submitted work item.
+     * Prepared SQEs (also the ones queued from completion callbacks) are
+     * flushed once per poll_completion_queues() call, or by flush().
+     */
+    bool deferred_submit = false;
+
+    /** max number of completions poll_completion_queues() handles per call.
+     * 1 keeps the latency of a single callback as low as possible,
+     * bulk receivers want a few hundred.
+     */
+    size_t completion_budget = 1;
+
+    /** When the SQ is full, work items wait in an overflow queue until SQ
+     * space frees up. Once that many are waiting the backpressure handler is
+     * told to slow down, and told again when it drained to half of it.
+     */
+    size_t pending_submissions_high_water = 1024;
+
+    /** Refuse to init() on kernels without IORING_FEAT_NODROP.
+     * Those drop completions when the CQ overflows, which loses multishot
+     * results and work item callbacks for good.
+     */
+    bool require_nodrop = true;
+
+    /** size of the sparse registered file table, 0 = no table.
+     * Sockets in it are used with IOSQE_FIXED_FILE,
+     * see IOUringInterface::register_fixed_socket().
+     */
+    unsigned fixed_file_slots = 0;
+
+    /** accepted connections go straight into the registered file table
+     * (accept_direct) and never get a normal fd. Needs fixed_file_slots.
+     */
+    bool direct_accept = false;
+
+    /** number of send packets that are built in the registered send arena,
+     * 0 = no arena. The arena is send_arena_slots * send_arena_slot_size bytes,
+     * mapped and pinned once during init(). Packets that find every slot
+     * in use allocate a buffer of their own.
+     */
+    size_t send_arena_slots = 256;
+
+    /** max size of a send packet in the arena */
+    size_t send_arena_slot_size = 4096;
+
+    /** Stream sends from the send arena of at least zero_copy_min_size bytes
+     * use zero-copy fixed-buffer sends (IORING_OP_SEND_ZC). Each one takes a
+     * second completion and keeps its slot until the kernel is done with it,
+     * which only pays off for large sends: raise send_arena_slot_size above
+     * zero_copy_min_size too.
+     */
+    bool zero_copy_send = false;
+    size_t zero_copy_min_size = 16384;
+
+    /** The receive buffer groups, e.g. 256 B for small datagrams and 64 KB
+     * for bulk TCP reads. Group i gets buffer group id i, receives use
+     * the group of their socket (ISocket::set_buffer_group()) unless
+     * submit_recv() is given one.
+     */
+    std::vector<BufferGroupConfig> buffer_groups{ BufferGroupConfig{} };
+
+    /** When a receive finds its buffer group empty (ENOBUFS), it is armed
+     * again on the ring of its size class with the most free buffers. If all
+     * of them are empty another ring of the class is added, this caps the
+     * memory of all receive buffers together. At the cap the receive waits
+     * until a buffer of its size class comes back.
+     */
+    size_t buffer_memory_cap = 64 << 20;
+
+    /** max number of receive buffers callbacks may keep at the same time
+     * with ReceivedMessage::take_lease(), 0 = no leases. Leased buffers are
+     * missing from their buffer group until released.
+     */
+    size_t max_buffer_leases = 256;
+
+    RingMemoryConfig memory;
+
+    /** @return the group with the smallest buffers that still fit
+     * 'message_size' bytes, or the group with the largest buffers.
+     */
+    uint16_t find_buffer_group(size_t message_size) const;
+};
+
+} // namespace iuring
@@ -0,0 +1,109 @@
+#pragma once
+
+/**
+ * @file IOUringGroup.hpp
+ * @brief Defines the IOUringGroup, a thread-per-core set of io_uring
+ * instances.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <slogger/Error.hpp>
+#include <slogger/ILogger.hpp>
+
+#include "IOUringConfig.hpp"
+#include "IOUringInterface.hpp"
+#include "ISocket.hpp"
+#include "NetworkAdapter.hpp"
+
+namespace iuring
+{
+struct IOUringGroupConfig
+{
+    /** number of rings, 0 = one per CPU */
+    size_t num_rings = 0;
+
+    /** CPU for each ring, ring i runs on cpus[i].
+     * Empty = ring i runs on CPU i.
+     */
+    std::vector<int> cpus;
+
+    /** used for every ring of the group */
+    IOUringConfig ring_config;
+
+    /** max time a ring thread sleeps in IOUringInterface::run_once() */
+    std::chrono::microseconds poll_timeout{ 100'000 };
+};
+
+/** Creates N rings, each with its own thread pinned to its own CPU.
+ *
+ * Every ring has its own WorkPool and buffer ring, nothing is shared
+ * between them. A ring must only be used from its own thread:
+ * do the per-ring work (e.g. create_listener() and submit_accept()) in the
+ * setup callback or in completion callbacks.
+ */
+class IOUringGroup
+{
+public:
+    using ring_setup_func_t = std::function<void(
+        size_t ring_index, const std::shared_ptr<IOUringInterface>& io)>;
+
+    IOUringGroup(logging::ILogger& logger, NetworkAdapter& adapter,
+        const IOUringGroupConfig& config);
+
+    IOUringGroup(const IOUringGroup&) = delete;
+    IOUringGroup& operator=(const IOUringGroup&) = delete;
+
+    ~IOUringGroup();
+
+    /** Starts the ring threads. Each one pins itself, creates and inits its
+     * ring, calls 'setup' and then runs the ring's event loop until stop().
+     * Returns once every ring finished its setup.
+     */
+    error::Error start(const ring_setup_func_t& setup);
+
+    /** stops and joins all ring threads */
+    void stop();
+
+    size_t size() const
+    {
+        return m_rings.size();
+    }
+
+    /** A SERVER_STREAM_SOCKET with SO_REUSEPORT, so each ring can listen on
+     * the same port and the kernel spreads the connections over the rings.
+     * Call it once per ring, from its setup callback.
+     */
+    std::shared_ptr<ISocket> create_listener(SocketType type, SocketPortID port);
+
+    /** only valid after start() */
+    const std::shared_ptr<IOUringInterface>& get_ring(size_t ring_index) const
+    {
+        return m_rings.at(ring_index);
+    }
+
+private:
+    logging::ILogger& m_logger;
+    NetworkAdapter& m_adapter;
+    IOUringGroupConfig m_config;
+
+    std::atomic<bool> m_running = false;
+    std::vector<std::shared_ptr<IOUringInterface>> m_rings;
+    std::vector<std::thread> m_threads;
+
+    logging::ILogger& get_logger()
+    {
+        return m_logger;
+    }
+
+    int get_cpu(size_t ring_index) const;
+
+    void run_ring(size_t ring_index);
+};
+
+} // namespace iuring
@@ -5,6 +5,7 @@
  * @brief Defines the IOUringInterface for asynchronous I/O operations.
  */
 
+#include <chrono>
 #include <memory>
 #include <expected>
 #include <functional>
@@ -17,6 +18,9 @@
 #include "IPAddress.hpp"
 #include "ISocket.hpp"
 #include "IWorkItem.hpp"
+#include "IOUringCapabilities.hpp"
+#include "IOUringConfig.hpp"
+#include "IOUringStats.hpp"
 #include "CompletionCallbacks.hpp"
 #include "NetworkAdapter.hpp"
 
@@ -32,12 +36,60 @@ public:
         const resolve_hostname_arg_t& result)>;
 
 
-    static std::shared_ptr<IOUringInterface> create_impl(logging::ILogger& logger, NetworkAdapter& adapter);
+    static std::shared_ptr<IOUringInterface> create_impl(logging::ILogger& logger, NetworkAdapter& adapter,
+        const IOUringConfig& config = {});
 
     virtual error::Error init() = 0;
 
+    /** @return the requested config with every mode the kernel refused
+     * switched off. Only meaningful after init().
+     */
+    virtual const IOUringConfig& get_active_config() const = 0;
+
+    /** what the running kernel supports, only meaningful after init() */
+    virtual const IOUringCapabilities& get_capabilities() const = 0;
+
+    virtual IOUringStats get_stats() const = 0;
+
+    /** called when submissions pile up because the SQ is full,
+     * see IOUringConfig::pending_submissions_high_water.
+     */
+    virtual void set_backpressure_handler(
+        backpressure_callback_func_t handler) = 0;
+
+    /** handles up to IOUringConfig::completion_budget completions
+     * without blocking.
+     */
     virtual error::Error poll_completion_queues() = 0;
 
+    /** handles up to 'budget' completions without blocking.
+     * @return the number of completions handled.
+     */
+    virtual std::expected<size_t, error::Error> reap_completions(
+        size_t budget) = 0;
+
+    /** Submits what is pending and sleeps in the kernel until at least
+     * 'min_events' completions are available or 'timeout' expired.
+     * Does not call any callbacks.
+     * @return the number of completions that are ready to be reaped.
+     */
+    virtual std::expected<size_t, error::Error> wait_for_completions(
+        size_t min_events, std::chrono::microseconds timeout) = 0;
+
+    /** One iteration of a blocking event loop:
+     * waits up to 'timeout' for a completion, then handles up to
+     * IOUringConfig::completion_budget of them.
+     * @return the number of completions handled, 0 on timeout.
+     */
+    virtual std::expected<size_t, error::Error> run_once(
+        std::chrono::microseconds timeout) = 0;
+
+    /** Hands all prepared but not yet submitted requests to the kernel.
+     * Only needed with IOUringConfig::deferred_submit when a request has to
+     * go out before the next poll_completion_queues() call.
+     */
+    virtual error::Error flush() = 0;
+
     virtual void resolve_hostname(const std::string& hostname,
         const resolve_hostname_callback_func_t& handler) = 0;
 
@@ -57,6 +109,39 @@ public:
     virtual void submit_recv(const std::shared_ptr<ISocket>& socket,
         recv_callback_func_t handler) = 0;
 
+    /** like submit_recv(), but takes the buffers from 'buffer_group'
+     * instead of the socket's group.
+     */
+    virtual void submit_recv(const std::shared_ptr<ISocket>& socket,
+        recv_callback_func_t handler, uint16_t buffer_group) = 0;
+
+    /** Stream sockets: one completion can fill several buffers of the
+     * socket's buffer group (IORING_RECVSEND_BUNDLE), 'handler' gets them
+     * all at once, in order. Without kernel support (< 6.10) every call
+     * gets a single message.
+     */
+    virtual void submit_recv_bundle(const std::shared_ptr<ISocket>& socket,
+        recv_batch_callback_func_t handler) = 0;
+
+    /** Datagram sockets: 'handler' is called once per poll with every
+     * datagram that arrived on the socket since the previous one, the
+     * buffers are recycled together after it returns.
+     * A poll handles at most IOUringConfig::completion_budget completions:
+     * with the default of 1 every call gets a single datagram, raise it
+     * to batch.
+     */
+    virtual void submit_recv_batch(const std::shared_ptr<ISocket>& socket,
+        recv_batch_callback_func_t handler) = 0;
+
+    /** Datagram sockets: packets sent with
+     * DatagramSendParameters::tx_timestamp get a software timestamp when
+     * they leave the stack. A receive on the socket's error queue reads
+     * them back and passes them to 'handler'.
+     */
+    virtual error::Error enable_tx_timestamps(
+        const std::shared_ptr<ISocket>& socket,
+        tx_timestamp_callback_func_t handler) = 0;
+
     /** The steps for sending a packet:
      *      - This returns a work-item where you can retrieve the SendPacket
      * object from
@@ -74,6 +159,36 @@ public:
 
     virtual void submit_close(const std::shared_ptr<ISocket>& socket,
         close_callback_func_t handler) = 0;
+
+    /** Puts 'socket' in a slot of the registered file table (see
+     * IOUringConfig::fixed_file_slots). All later operations on it skip the
+     * per-request fd lookup. The slot is freed again by submit_close().
+     */
+    virtual error::Error register_fixed_socket(
+        const std::shared_ptr<ISocket>& socket) = 0;
+
+    /** Posts 'msg' to the completion queue of 'target' (IORING_OP_MSG_RING),
+     * without locks or wakeup fds. The target ring's thread receives it in
+     * the handler set with set_ring_message_handler().
+     */
+    virtual void post_to_ring(const std::shared_ptr<IOUringInterface>& target,
+        const RingMessage& msg) = 0;
+
+    /** Moves 'socket' to 'target', for example to balance accepted
+     * connections over the rings of an IOUringGroup.
+     * The target ring's thread receives it in the handler set with
+     * set_socket_handoff_handler(). Stop using the socket on this ring
+     * after the call. A socket that only lives in the registered file table
+     * (direct_accept) moves to a slot of the target's table.
+     */
+    virtual void handoff_socket(const std::shared_ptr<IOUringInterface>& target,
+        const std::shared_ptr<ISocket>& socket) = 0;
+
+    virtual void set_ring_message_handler(
+        ring_message_callback_func_t handler) = 0;
+
+    virtual void set_socket_handoff_handler(
+        socket_handoff_callback_func_t handler) = 0;
 };
 
 
@@ -0,0 +1,59 @@
+#pragma once
+
+/**
+ * @file IOUringStats.hpp
+ * @brief Defines the counters reported by IOUringInterface::get_stats().
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace iuring
+{
+struct IOUringStats
+{
+    /** work items that found the SQ full and had to wait in the overflow
+     * queue
+     */
+    uint64_t submissions_queued = 0;
+
+    /** work items currently waiting for SQ space */
+    size_t pending_submissions = 0;
+
+    /** the highest pending_submissions seen so far */
+    size_t max_pending_submissions = 0;
+
+    /** how often the pending queue crossed the high-water mark */
+    uint64_t backpressure_events = 0;
+
+    /** how often completions backlogged by a full CQ were flushed back */
+    uint64_t cq_overflow_flushes = 0;
+
+    /** completions the kernel could not keep, as reported by the CQ
+     * overflow counter. Anything but 0 means lost callbacks.
+     */
+    uint64_t cq_dropped = 0;
+
+    /** send packets that got no send arena slot because all were in use */
+    uint64_t send_arena_exhausted = 0;
+
+    /** receives that found no free buffer in their buffer group */
+    uint64_t enobufs = 0;
+
+    /** buffer rings added because a size class ran out of buffers */
+    uint64_t buffer_groups_added = 0;
+
+    /** starved receives that had to wait for a buffer to come back, as
+     * every ring of their size class was empty and no more could be added
+     */
+    uint64_t starved_rearms = 0;
+
+    /** receive buffers leased by callbacks and not yet back in their group
+     */
+    size_t buffer_leases = 0;
+
+    /** take_lease() calls refused because max_buffer_leases were out */
+    uint64_t buffer_leases_refused = 0;
+};
+
+} // namespace iuring
@@ -68,10 +68,10 @@ public:
     }
 
     IPAddress(const sockaddr_storage& sa, socklen_t len)
-        : m_in4(len == sizeof(sockaddr_in) ?
+        : m_in4(len != sizeof(sockaddr_in) ?
                   std::nullopt :
                   std::optional<sockaddr_in>(*(sockaddr_in*) &sa))
-        , m_in6(len == sizeof(sockaddr_in6) ?
+        , m_in6(len != sizeof(sockaddr_in6) ?
                   std::nullopt :
                   std::optional<sockaddr_in6>(*(sockaddr_in6*) &sa))
     {
@@ -23,6 +23,7 @@
 #include <cassert>
 #include <cstring>
 
+#include <slogger/Error.hpp>
 #include <slogger/ILogger.hpp>
 #include <slogger/StringUtils.hpp>
 
@@ -62,16 +63,103 @@ public:
 
     virtual int mcast_bind() = 0;
 
+    /** Sets the socket option behind 'control' and lets the ring's receives
+     * make room for its control messages. Only for datagram sockets.
+     */
+    virtual error::Error enable_receive_control(ReceiveControl control) = 0;
+
+    /** Sets up SO_TIMESTAMPING so that datagrams sent with a timestamp
+     * request report it, with a per-packet id, on the error queue. Use
+     * IOUringInterface::enable_tx_timestamps() to read them.
+     */
+    virtual error::Error enable_tx_timestamps() = 0;
+
+    /** restarts the kernel's TX timestamp id count (OPT_ID) and ours at 0,
+     * in a new generation. For after a timestamped send failed.
+     */
+    virtual error::Error resync_tx_timestamp_ids() = 0;
+
     virtual void join_multicast_group(
         const std::string& ip_address, const std::string& source_iface) = 0;
 
     virtual ~ISocket() = default;
 
+    /** -1 for sockets that only live in the ring's fixed file table
+     * (see IOUringConfig::direct_accept).
+     */
     int get_fd() const
     {
         return m_fd;
     }
 
+    /** the slot in the registered file table of the ring that uses this
+     * socket, see IOUringInterface::register_fixed_socket().
+     */
+    std::optional<unsigned> get_fixed_slot() const
+    {
+        return m_fixed_slot;
+    }
+
+    void set_fixed_slot(std::optional<unsigned> slot)
+    {
+        m_fixed_slot = slot;
+    }
+
+    /** the receive buffer group (an index in IOUringConfig::buffer_groups)
+     * receives on this socket take their buffers from.
+     */
+    uint16_t get_buffer_group() const
+    {
+        return m_buffer_group;
+    }
+
+    void set_buffer_group(uint16_t bgid)
+    {
+        m_buffer_group = bgid;
+    }
+
+    bool has_receive_control(ReceiveControl control) const
+    {
+        return m_receive_control & static_cast<uint32_t>(control);
+    }
+
+    /** the id of the next datagram sent with a TX timestamp request.
+     * The packet carries it (has_per_packet_tx_id()), or the kernel counts
+     * timestamped packets from 0 as well.
+     * @return std::nullopt before enable_tx_timestamps()
+     */
+    std::optional<uint32_t> next_tx_timestamp_id()
+    {
+        if (!m_tx_timestamps)
+        {
+            return std::nullopt;
+        }
+        return m_tx_timestamp_id++;
+    }
+
+    /** SCM_TS_OPT_ID: every packet tells the kernel its id */
+    bool has_per_packet_tx_id() const
+    {
+        return m_tx_id_per_packet;
+    }
+
+    /** the kernel rejected SCM_TS_OPT_ID, count the ids instead */
+    void disable_per_packet_tx_id()
+    {
+        m_tx_id_per_packet = false;
+    }
+
+    uint32_t get_tx_timestamp_generation() const
+    {
+        return m_tx_timestamp_generation;
+    }
+
+    /** all enabled ReceiveControl bits */
+    uint32_t get_receive_controls() const
+    {
+        return m_receive_control;
+    }
+
 
     SocketPortID get_port() const
     {
@@ -103,6 +191,11 @@ public:
         return m_type;
     }
 
+    bool is_ipv6() const
+    {
+        return m_type == SocketType::IPV6_UDP || m_type == SocketType::IPV6_TCP;
+    }
+
     logging::ILogger& get_logger()
     {
         return m_logger;
@@ -124,14 +217,46 @@ private:
     logging::ILogger& m_logger;
     SocketKind m_kind;
     int m_fd;
+    std::optional<unsigned> m_fixed_slot;
+    uint16_t m_buffer_group = 0;
+    uint32_t m_receive_control = 0;
+    bool m_tx_timestamps = false;
+    bool m_tx_id_per_packet = false;
+    uint32_t m_tx_timestamp_id = 0;
+    uint32_t m_tx_timestamp_generation = 0;
 
     std::shared_ptr<IConnectionData> m_connection_data;
 
+protected:
+    void add_receive_control(ReceiveControl control)
+    {
+        m_receive_control |= static_cast<uint32_t>(control);
+    }
+
+    /** called by enable_tx_timestamps() */
+    void set_tx_timestamps_enabled(bool per_packet_id)
+    {
+        m_tx_timestamps = true;
+        m_tx_id_per_packet = per_packet_id;
+    }
+
+    /** the kernel's count restarted at 0, ids given out before are void */
+    void reset_tx_timestamp_id()
+    {
+        m_tx_timestamp_id = 0;
+        m_tx_timestamp_generation++;
+    }
+
 private:
     friend class SocketFactoryImpl;
+    friend class IOUringGroup;
 
+    /** 'reuse_port': a SERVER_STREAM_SOCKET shares its port with the other
+     * listeners that set it (SO_REUSEPORT), see IOUringGroup
+     */
     static std::shared_ptr<ISocket> create_impl(SocketType type,
-        SocketPortID port, logging::ILogger& logger, SocketKind kind);
+        SocketPortID port, logging::ILogger& logger, SocketKind kind,
+        bool reuse_port = false);
 
     static std::shared_ptr<ISocket> create_impl(
         logging::ILogger& logger, const AcceptResult& res);
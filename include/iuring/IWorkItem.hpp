@@ -23,6 +23,10 @@ struct DatagramSendParameters
     IPAddress destination_address;
     dscp_t dscp;
     timetolive_t ttl;
+    /** report when the packet left the stack, see
+     * IOUringInterface::enable_tx_timestamps()
+     */
+    bool tx_timestamp = false;
 };
 
 
@@ -37,7 +41,8 @@ public:
         SEND_WORKPACKET,
         RECV,
         CONNECT,
-        CLOSE
+        CLOSE,
+        MSG_RING
     };
 
     virtual ~IWorkItem() {}
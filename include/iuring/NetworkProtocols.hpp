@@ -28,6 +28,35 @@ enum class SocketType
     IPV6_TCP
 };
 
+/** Information a datagram socket asks the kernel to hand over with every
+ * received datagram, see ISocket::enable_receive_control(). The ring
+ * reserves control message space for it and fills in ReceiveMetadata.
+ */
+enum class ReceiveControl : uint32_t
+{
+    /** coalesce datagrams of the same flow into one buffer (UDP_GRO).
+     * The coalesced data is up to 64 KB, use a buffer group that large.
+     */
+    GRO = 1 << 0,
+
+    /** the time the kernel received the datagram (SO_TIMESTAMPING with
+     * software RX timestamps)
+     */
+    TIMESTAMP = 1 << 1,
+
+    /** the destination address and the interface the datagram arrived on
+     * (IP_PKTINFO / IPV6_RECVPKTINFO), e.g. to tell multicast groups apart
+     * on one socket
+     */
+    PACKET_INFO = 1 << 2,
+
+    /** the TOS byte / IPv6 traffic class of the datagram */
+    TOS = 1 << 3,
+
+    /** the TTL / IPv6 hop limit the datagram arrived with */
+    TTL = 1 << 4,
+};
+
 
 enum class timetolive_t : uint8_t
 {
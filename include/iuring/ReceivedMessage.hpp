@@ -1,20 +1,75 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <optional>
 #include <string>
 
+#include <iuring/BufferLease.hpp>
 #include <iuring/IPAddress.hpp>
 
 namespace iuring
 {
+/** What the kernel told about a received datagram in control messages.
+ * Only filled in for the controls enabled on the socket
+ * (ISocket::enable_receive_control()).
+ */
+struct ReceiveMetadata
+{
+    /** UDP_GRO: the data holds several datagrams of the same sender, each
+     * this big except the last one. See ReceivedMessage::get_segment().
+     */
+    std::optional<uint16_t> m_gro_segment_size;
+
+    /** TIMESTAMP: when the kernel received the datagram, CLOCK_REALTIME
+     * since the epoch
+     */
+    std::optional<std::chrono::nanoseconds> m_timestamp;
+
+    /** PACKET_INFO: the destination address of the IP header, e.g. the
+     * multicast group. Its port is not set.
+     */
+    std::optional<IPAddress> m_destination;
+
+    /** PACKET_INFO: the index of the interface the datagram arrived on */
+    std::optional<unsigned> m_interface_index;
+
+    /** TOS: the TOS byte (DSCP + ECN) or IPv6 traffic class */
+    std::optional<uint8_t> m_tos;
+
+    /** TTL: the TTL or IPv6 hop limit */
+    std::optional<uint8_t> m_ttl;
+};
+
 class ReceivedMessage
 {
 public:
-    ReceivedMessage(const uint8_t* data, size_t size, const IPAddress& sa)
+    ReceivedMessage(const uint8_t* data, size_t size, const IPAddress& sa,
+        LeasableBuffer* leasable = nullptr)
         : m_data(data)
         , m_size(size)
         , m_source_address(sa)
+        , m_leasable(leasable)
+    {
+    }
+
+    /** Keeps the receive buffer from the ring after the callback returned,
+     * instead of copying the data. Messages that share a buffer (the
+     * segments of a GRO receive) can each take a lease, the buffer goes back
+     * to the ring with the last one.
+     * @return std::nullopt if the ring's lease limit
+     * (IOUringConfig::max_buffer_leases buffers) is reached, or the buffer
+     * can't be leased (incremental buffer groups).
+     */
+    std::optional<BufferLease> take_lease() const
     {
+        if (!m_leasable)
+        {
+            return std::nullopt;
+        }
+        return m_leasable->lease(m_data, m_size);
     }
 
     std::string to_string() const
@@ -48,10 +103,57 @@ public:
         return m_source_address;
     }
 
+    const ReceiveMetadata& get_metadata() const
+    {
+        return m_metadata;
+    }
+
+    void set_metadata(const ReceiveMetadata& metadata)
+    {
+        m_metadata = metadata;
+    }
+
+    /** 1, or the number of datagrams UDP_GRO coalesced into this message */
+    size_t get_segment_count() const
+    {
+        const auto segment_size = m_metadata.m_gro_segment_size.value_or(0);
+        if (segment_size == 0 || m_size == 0)
+        {
+            return 1;
+        }
+        return (m_size + segment_size - 1) / segment_size;
+    }
+
+    /** The i-th datagram of a UDP_GRO message, pointing into the same
+     * buffer. A lease taken from a segment keeps the whole buffer.
+     */
+    ReceivedMessage get_segment(size_t i) const
+    {
+        assert(i < get_segment_count());
+        const auto segment_size = m_metadata.m_gro_segment_size.value_or(0);
+        if (segment_size == 0)
+        {
+            return *this;
+        }
+
+        const auto offset = i * segment_size;
+        ReceivedMessage segment(m_data + offset,
+            std::min<size_t>(segment_size, m_size - offset), m_source_address,
+            m_leasable);
+        segment.m_metadata = m_metadata;
+        segment.m_metadata.m_gro_segment_size.reset();
+        return segment;
+    }
+
 private:
     const uint8_t* m_data;
     size_t m_size;
     IPAddress m_source_address;
+    LeasableBuffer* m_leasable;
+    ReceiveMetadata m_metadata;
+
+    friend class IOUring;
+    friend class ReceiveBatch;
 };
 
 
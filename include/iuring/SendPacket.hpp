@@ -3,15 +3,26 @@
 #include <stdlib.h>
 #include <arpa/inet.h>
 
-#include <array>
-#include <string>
 #include <cassert>
+#include <cstring>
+#include <memory>
+#include <string>
 
 namespace iuring
 {
+/** The payload of a send. The ring builds it in a slot of its registered
+ * send arena (see IOUringConfig::send_arena_slots), a packet without one
+ * allocates its own buffer on first use.
+ */
 class SendPacket
 {
 public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    SendPacket() = default;
+    SendPacket(const SendPacket&) = delete;
+    SendPacket& operator=(const SendPacket&) = delete;
+
     void append_byte(uint8_t b)
     {
         append(&b, 1);
@@ -46,16 +57,16 @@ public:
 
     void append(const uint8_t* data, size_t len)
     {
-        assert((m_size + len) < m_buf.size());
-        memcpy(&m_buf[m_size], data, len);
+        assert((m_size + len) < capacity());
+        memcpy(buf() + m_size, data, len);
         m_size += len;
     }
 
     template<class T, class... Args>
     void emplace_back(Args&&... args)
     {
-        assert((m_size + sizeof(T)) < m_buf.size());
-        auto* ptr = &m_buf[m_size];
+        assert((m_size + sizeof(T)) < capacity());
+        auto* ptr = buf() + m_size;
 
         memset(ptr, 0, sizeof(T)); // NOTE: memset possibly superfluous if T's ctor is ok
         new(ptr) T(args...);
@@ -65,14 +76,50 @@ public:
 
     void reset()
     {
-        memset(m_buf.data(), 0, m_size);
+        if (m_data)
+        {
+            memset(m_data, 0, m_size);
+        }
         m_size = 0;
     }
 
     void clean_proper()
     {
         m_size = 0;
-        m_buf.fill(0);
+        if (m_data)
+        {
+            memset(m_data, 0, m_capacity);
+        }
+    }
+
+    /** Writes to 'storage' (e.g. a slot of the registered send arena)
+     * instead of a buffer of its own, until detach_storage().
+     */
+    void attach_storage(uint8_t* storage, size_t capacity)
+    {
+        assert(storage);
+        m_owned.reset();
+        m_data = storage;
+        m_capacity = capacity;
+        m_size = 0;
+    }
+
+    void detach_storage()
+    {
+        m_owned.reset();
+        m_data = nullptr;
+        m_capacity = 0;
+        m_size = 0;
+    }
+
+    bool has_external_storage() const
+    {
+        return m_data != nullptr && !m_owned;
+    }
+
+    size_t capacity() const
+    {
+        return m_data ? m_capacity : DEFAULT_CAPACITY;
     }
 
     size_t size() const
@@ -80,19 +127,37 @@ public:
         return m_size;
     }
 
+    /** nullptr until something was appended or storage was attached */
     const uint8_t* data() const
     {
-        return m_buf.data();
+        return m_data;
     }
 
     std::string to_string() const
     {
-        return std::string(reinterpret_cast<const char*>( m_buf.data() ), m_size);
+        if (m_size == 0)
+        {
+            return {};
+        }
+        return std::string(reinterpret_cast<const char*>( m_data ), m_size);
     }
 
 private:
     size_t m_size = 0;
-    std::array<uint8_t, 4096> m_buf;
+    uint8_t* m_data = nullptr;
+    size_t m_capacity = 0;
+    std::unique_ptr<uint8_t[]> m_owned;
+
+    uint8_t* buf()
+    {
+        if (!m_data)
+        {
+            m_owned = std::make_unique<uint8_t[]>(DEFAULT_CAPACITY);
+            m_data = m_owned.get();
+            m_capacity = DEFAULT_CAPACITY;
+        }
+        return m_data;
+    }
 };
 
 } // namespace iuring
\ No newline at end of file
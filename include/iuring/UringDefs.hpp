@@ -47,8 +47,14 @@ enum class UringFeature
     IORING_OP_MKDIRAT,
     IORING_OP_SYMLINKAT,
     IORING_OP_LINKAT,
+    IORING_OP_MSG_RING,
+    IORING_OP_SEND_ZC,
+    IORING_OP_SOCKET,
 #if SUPPORT_LISTEN_IN_LIBURING
     IORING_OP_LISTEN,
 #endif
+
+    /** number of entries, keep last */
+    COUNT
 };
 } // namespace iuring
\ No newline at end of file
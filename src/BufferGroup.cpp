@@ -0,0 +1,160 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* See feature_test_macros(7) */
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include "BufferGroup.hpp"
+
+namespace iuring
+{
+error::Error BufferGroup::init(uint16_t bgid, size_t buffer_size,
+    unsigned count, bool incremental, const RingMemoryConfig& memory)
+{
+    assert(!m_buf_ring);
+    assert(buffer_size > 0);
+    assert(count > 0 && (count & (count - 1)) == 0);
+
+    m_bgid = bgid;
+    m_buffer_size = buffer_size;
+    m_count = count;
+
+    // the ring entries, followed by the buffers themselves
+    if (auto ret = m_memory.map(memory_size(buffer_size, count), memory);
+        ret != error::Error::OK)
+    {
+        return ret;
+    }
+    m_buf_ring = (struct io_uring_buf_ring*) m_memory.data();
+
+    io_uring_buf_ring_init(m_buf_ring);
+
+    m_buffer_base = (uint8_t*) m_buf_ring + sizeof(io_uring_buf) * count;
+    m_consumed.assign(count, 0);
+    m_ring_order.resize(count);
+    m_position.resize(count);
+
+    auto ret = register_ring(incremental);
+    if (ret != error::Error::OK && incremental)
+    {
+        LOG_INFO(get_logger(),
+            "buffer group {}: no incremental buffer rings (needs kernel "
+            ">= 6.12), using whole buffers",
+            bgid);
+        ret = register_ring(false);
+    }
+    if (ret != error::Error::OK)
+    {
+        m_memory.unmap();
+        m_buf_ring = nullptr;
+        return ret;
+    }
+
+    const auto mask = io_uring_buf_ring_mask(count);
+    for (auto i = 0u; i < count; i++)
+    {
+        io_uring_buf_ring_add(
+            m_buf_ring, get_buffer(i), buffer_size, i, mask, i);
+        m_ring_order[i] = i;
+        m_position[i] = i;
+    }
+    io_uring_buf_ring_advance(m_buf_ring, count);
+    m_tail = count;
+
+    LOG_INFO(get_logger(), "buffer group {}: {} buffers of {} bytes{}{}", bgid,
+        count, buffer_size, m_incremental ? " (incremental)" : "",
+        m_memory.uses_huge_pages() ? " (huge pages)" : "");
+    return error::Error::OK;
+}
+
+
+error::Error BufferGroup::register_ring(bool incremental)
+{
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (unsigned long) m_buf_ring;
+    reg.ring_entries = m_count;
+    reg.bgid = m_bgid;
+#ifdef IOU_PBUF_RING_INC
+    if (incremental)
+    {
+        reg.flags |= IOU_PBUF_RING_INC;
+    }
+#else
+    if (incremental)
+    {
+        return error::errno_to_error(EINVAL);
+    }
+#endif
+
+    const auto ret = io_uring_register_buf_ring(&m_ring, &reg, 0);
+    if (ret)
+    {
+        if (!incremental)
+        {
+            LOG_ERROR(get_logger(),
+                "buf_ring init failed: {}\n"
+                "NB This requires a kernel version >= 6.0\n",
+                strerror(-ret));
+        }
+        return error::errno_to_error(-ret);
+    }
+
+    m_incremental = incremental;
+    return error::Error::OK;
+}
+
+
+bool BufferGroup::consume(unsigned idx, size_t len, uint32_t cqe_flags)
+{
+    assert(idx < m_count);
+#ifdef IORING_CQE_F_BUF_MORE
+    if (m_incremental && (cqe_flags & IORING_CQE_F_BUF_MORE))
+    {
+        // the kernel continues filling this buffer after our data
+        m_consumed[idx] += len;
+        assert(m_consumed[idx] <= m_buffer_size);
+        return false;
+    }
+#endif
+    m_consumed[idx] = 0;
+    return true;
+}
+
+
+void BufferGroup::release(unsigned idx, size_t len, uint32_t cqe_flags)
+{
+    if (consume(idx, len, cqe_flags))
+    {
+        recycle(idx);
+    }
+}
+
+
+std::optional<unsigned> BufferGroup::free_buffers() const
+{
+    uint16_t head = 0;
+    if (io_uring_buf_ring_head(&m_ring, m_bgid, &head) < 0)
+    {
+        return std::nullopt;
+    }
+    // both wrap at 16 bits
+    return static_cast<uint16_t>(m_tail - head);
+}
+
+
+void BufferGroup::recycle(unsigned idx)
+{
+    const auto mask = io_uring_buf_ring_mask(m_count);
+    io_uring_buf_ring_add(
+        m_buf_ring, get_buffer(idx), m_buffer_size, idx, mask, 0);
+    io_uring_buf_ring_advance(m_buf_ring, 1);
+
+    const auto pos = m_tail & mask;
+    m_ring_order[pos] = idx;
+    m_position[idx] = pos;
+    m_tail++;
+}
+
+} // namespace iuring
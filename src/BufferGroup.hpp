@@ -0,0 +1,172 @@
+#pragma once
+
+/**
+ * @file BufferGroup.hpp
+ * @brief Defines the BufferGroup, one provided-buffer ring of equally
+ * sized receive buffers.
+ */
+
+#include <liburing.h>
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <slogger/Error.hpp>
+#include <slogger/ILogger.hpp>
+
+#include "RingMemory.hpp"
+
+namespace iuring
+{
+/** The kernel picks a buffer from the group for every receive
+ * (IOSQE_BUFFER_SELECT with sqe->buf_group == get_bgid()), the buffer id
+ * comes back in the CQE flags. After handling the data, release() hands
+ * the buffer back to the kernel.
+ *
+ * In incremental mode the kernel puts the data of several receives after
+ * each other in the same buffer, the CQE says whether it keeps using it
+ * (IORING_CQE_F_BUF_MORE).
+ */
+class BufferGroup
+{
+public:
+    /** @param size_class the IOUringConfig::buffer_groups entry this ring
+     * provides buffers for
+     */
+    BufferGroup(logging::ILogger& logger, io_uring& ring, uint16_t size_class)
+        : m_logger(logger)
+        , m_ring(ring)
+        , m_size_class(size_class)
+        , m_memory(logger)
+    {
+    }
+
+    BufferGroup(const BufferGroup&) = delete;
+    BufferGroup& operator=(const BufferGroup&) = delete;
+
+    /** @param count must be a power of 2
+     * @param incremental ask for IOU_PBUF_RING_INC, see is_incremental()
+     */
+    error::Error init(uint16_t bgid, size_t buffer_size, unsigned count,
+        bool incremental, const RingMemoryConfig& memory);
+
+    /** false if incremental mode was not asked for or not supported */
+    bool is_incremental() const
+    {
+        return m_incremental;
+    }
+
+    uint16_t get_bgid() const
+    {
+        return m_bgid;
+    }
+
+    uint16_t get_size_class() const
+    {
+        return m_size_class;
+    }
+
+    /** the memory a group of 'count' buffers of 'buffer_size' takes */
+    static size_t memory_size(size_t buffer_size, unsigned count)
+    {
+        return (sizeof(io_uring_buf) + buffer_size) * count;
+    }
+
+    size_t buffer_size() const
+    {
+        return m_buffer_size;
+    }
+
+    unsigned count() const
+    {
+        return m_count;
+    }
+
+    uint8_t* get_buffer(unsigned idx)
+    {
+        assert(idx < m_count);
+        return m_buffer_base + idx * m_buffer_size;
+    }
+
+    /** @return where the data of a receive into buffer 'idx' starts */
+    uint8_t* get_data(unsigned idx)
+    {
+        assert(idx < m_count);
+        return get_buffer(idx) + m_consumed[idx];
+    }
+
+    /** @return the buffer the kernel takes after 'idx', i.e. where a
+     * bundle receive that started in 'idx' continues
+     */
+    unsigned next_in_ring(unsigned idx) const
+    {
+        assert(idx < m_count);
+        const auto mask = io_uring_buf_ring_mask(m_count);
+        return m_ring_order[(m_position[idx] + 1) & mask];
+    }
+
+    /** @return the buffers the kernel can still pick, std::nullopt if it
+     * can't tell (kernels < 6.8)
+     */
+    std::optional<unsigned> free_buffers() const;
+
+    /** @return how many buffers went to the kernel so far, it wraps. A
+     * change means one came back.
+     */
+    unsigned get_recycled() const
+    {
+        return m_tail;
+    }
+
+    /** the receive of a CQE is done with 'len' bytes of buffer 'idx'.
+     * @param cqe_flags the flags of the receive's CQE
+     * @return true if the kernel is done with the buffer too, it goes back
+     * with recycle()
+     */
+    bool consume(unsigned idx, size_t len, uint32_t cqe_flags);
+
+    /** hands buffer 'idx' back to the kernel */
+    void recycle(unsigned idx);
+
+    /** done with 'len' bytes of buffer 'idx'.
+     * @param cqe_flags the flags of the receive's CQE
+     */
+    void release(unsigned idx, size_t len, uint32_t cqe_flags);
+
+private:
+    logging::ILogger& m_logger;
+    io_uring& m_ring;
+    uint16_t m_size_class;
+
+    uint16_t m_bgid = 0;
+    size_t m_buffer_size = 0;
+    unsigned m_count = 0;
+
+    /** the registration ends with the ring, the memory only needs unmapping
+     */
+    RingMemory m_memory;
+    io_uring_buf_ring* m_buf_ring = nullptr;
+    uint8_t* m_buffer_base = nullptr;
+
+    bool m_incremental = false;
+    /** incremental mode: bytes of each buffer the kernel already filled */
+    std::vector<size_t> m_consumed;
+
+    /** which buffer went into which ring entry, and back. Buffers are
+     * recycled out of order, so the ring order is not the id order.
+     */
+    std::vector<unsigned> m_ring_order;
+    std::vector<unsigned> m_position;
+    unsigned m_tail = 0;
+
+    error::Error register_ring(bool incremental);
+
+    logging::ILogger& get_logger()
+    {
+        return m_logger;
+    }
+};
+
+} // namespace iuring
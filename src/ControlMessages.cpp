@@ -0,0 +1,181 @@
+#include <time.h>
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "ControlMessages.hpp"
+
+namespace iuring
+{
+namespace
+{
+    bool has(uint32_t controls, ReceiveControl control)
+    {
+        return controls & static_cast<uint32_t>(control);
+    }
+
+    template <typename T> T read_cmsg_data(const cmsghdr& cmsg)
+    {
+        // CMSG_DATA need not be aligned for T
+        T value{};
+        memcpy(&value, CMSG_DATA(&cmsg),
+            std::min(sizeof(T), cmsg.cmsg_len - CMSG_LEN(0)));
+        return value;
+    }
+
+    std::chrono::nanoseconds to_nanoseconds(const timespec& ts)
+    {
+        return std::chrono::seconds(ts.tv_sec) +
+            std::chrono::nanoseconds(ts.tv_nsec);
+    }
+
+    /** ts[0] is the software timestamp, ts[2] the hardware one */
+    std::optional<std::chrono::nanoseconds> software_timestamp(
+        const cmsghdr& cmsg)
+    {
+        const auto ts = read_cmsg_data<scm_timestamping>(cmsg);
+        if (ts.ts[0].tv_sec == 0 && ts.ts[0].tv_nsec == 0)
+        {
+            return std::nullopt;
+        }
+        return to_nanoseconds(ts.ts[0]);
+    }
+} // namespace
+
+
+size_t receive_control_space(uint32_t controls)
+{
+    size_t space = 0;
+    if (has(controls, ReceiveControl::GRO))
+    {
+        space += CMSG_SPACE(sizeof(int));
+    }
+    if (has(controls, ReceiveControl::TIMESTAMP))
+    {
+        space += CMSG_SPACE(sizeof(scm_timestamping));
+    }
+    if (has(controls, ReceiveControl::PACKET_INFO))
+    {
+        space += std::max(
+            CMSG_SPACE(sizeof(in_pktinfo)), CMSG_SPACE(sizeof(in6_pktinfo)));
+    }
+    if (has(controls, ReceiveControl::TOS))
+    {
+        space += CMSG_SPACE(sizeof(int));
+    }
+    if (has(controls, ReceiveControl::TTL))
+    {
+        space += CMSG_SPACE(sizeof(int));
+    }
+    return space;
+}
+
+
+void parse_control_message(const cmsghdr& cmsg, ReceiveMetadata& metadata)
+{
+    switch (cmsg.cmsg_level)
+    {
+    case SOL_UDP:
+#ifdef UDP_GRO
+        if (cmsg.cmsg_type == UDP_GRO)
+        {
+            metadata.m_gro_segment_size =
+                static_cast<uint16_t>(read_cmsg_data<int>(cmsg));
+        }
+#endif
+        break;
+
+    case SOL_SOCKET:
+        if (cmsg.cmsg_type == SCM_TIMESTAMPING)
+        {
+            if (const auto ts = software_timestamp(cmsg))
+            {
+                metadata.m_timestamp = ts;
+            }
+        }
+        else if (cmsg.cmsg_type == SCM_TIMESTAMPNS)
+        {
+            metadata.m_timestamp =
+                to_nanoseconds(read_cmsg_data<timespec>(cmsg));
+        }
+        break;
+
+    case SOL_IP:
+        if (cmsg.cmsg_type == IP_PKTINFO)
+        {
+            const auto info = read_cmsg_data<in_pktinfo>(cmsg);
+            metadata.m_destination =
+                IPAddress(info.ipi_addr, static_cast<SocketPortID>(0));
+            metadata.m_interface_index = info.ipi_ifindex;
+        }
+        else if (cmsg.cmsg_type == IP_TOS)
+        {
+            // a single byte, unlike the other ones
+            metadata.m_tos = read_cmsg_data<uint8_t>(cmsg);
+        }
+        else if (cmsg.cmsg_type == IP_TTL)
+        {
+            metadata.m_ttl = static_cast<uint8_t>(read_cmsg_data<int>(cmsg));
+        }
+        break;
+
+    case SOL_IPV6:
+        if (cmsg.cmsg_type == IPV6_PKTINFO)
+        {
+            const auto info = read_cmsg_data<in6_pktinfo>(cmsg);
+            metadata.m_destination =
+                IPAddress(info.ipi6_addr, static_cast<SocketPortID>(0));
+            metadata.m_interface_index = info.ipi6_ifindex;
+        }
+        else if (cmsg.cmsg_type == IPV6_TCLASS)
+        {
+            metadata.m_tos = static_cast<uint8_t>(read_cmsg_data<int>(cmsg));
+        }
+        else if (cmsg.cmsg_type == IPV6_HOPLIMIT)
+        {
+            metadata.m_ttl = static_cast<uint8_t>(read_cmsg_data<int>(cmsg));
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+size_t error_queue_control_space()
+{
+    // the error carries the offending address after it
+    return CMSG_SPACE(sizeof(scm_timestamping)) +
+        CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6));
+}
+
+
+void parse_error_queue_message(const cmsghdr& cmsg, TxTimestampParts& parts)
+{
+    const bool is_error = (cmsg.cmsg_level == SOL_IP &&
+                              cmsg.cmsg_type == IP_RECVERR) ||
+        (cmsg.cmsg_level == SOL_IPV6 && cmsg.cmsg_type == IPV6_RECVERR);
+
+    if (is_error)
+    {
+        const auto err = read_cmsg_data<sock_extended_err>(cmsg);
+        if (err.ee_errno == ENOMSG &&
+            err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING)
+        {
+            parts.m_id = err.ee_data;
+        }
+    }
+    else if (cmsg.cmsg_level == SOL_SOCKET &&
+        cmsg.cmsg_type == SCM_TIMESTAMPING)
+    {
+        parts.m_timestamp = software_timestamp(cmsg);
+    }
+}
+
+} // namespace iuring
@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+ * @file ControlMessages.hpp
+ * @brief Declares the helpers for the control messages of datagram
+ * receives.
+ */
+
+#include <sys/socket.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include <iuring/ReceivedMessage.hpp>
+
+namespace iuring
+{
+/** @return the msg_controllen a receive needs for the control messages
+ * of 'controls' (ReceiveControl bits)
+ */
+size_t receive_control_space(uint32_t controls);
+
+/** fills in what 'cmsg' says about a received datagram into 'metadata',
+ * control messages it does not know are ignored.
+ */
+void parse_control_message(const cmsghdr& cmsg, ReceiveMetadata& metadata);
+
+/** the two control messages of an error queue message that make up a
+ * TX timestamp
+ */
+struct TxTimestampParts
+{
+    /** sock_extended_err::ee_data of a SO_EE_ORIGIN_TIMESTAMPING error */
+    std::optional<uint32_t> m_id;
+    std::optional<std::chrono::nanoseconds> m_timestamp;
+};
+
+/** @return the msg_controllen an error queue receive needs for a TX
+ * timestamp
+ */
+size_t error_queue_control_space();
+
+void parse_error_queue_message(const cmsghdr& cmsg, TxTimestampParts& parts);
+
+} // namespace iuring
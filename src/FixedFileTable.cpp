@@ -0,0 +1,44 @@
+#include "FixedFileTable.hpp"
+
+namespace iuring
+{
+void FixedFileTable::reset(unsigned size)
+{
+    std::lock_guard lock(m_mutex);
+    m_size = size;
+    m_used.assign(size, false);
+    m_free_slots.clear();
+    m_free_slots.reserve(size);
+    for (unsigned i = size; i > 0; i--)
+    {
+        m_free_slots.push_back(i - 1);
+    }
+}
+
+
+std::optional<unsigned> FixedFileTable::alloc()
+{
+    std::lock_guard lock(m_mutex);
+    if (m_free_slots.empty())
+    {
+        return std::nullopt;
+    }
+
+    const auto slot = m_free_slots.back();
+    m_free_slots.pop_back();
+    assert(!m_used[slot]);
+    m_used[slot] = true;
+    return slot;
+}
+
+
+void FixedFileTable::release(unsigned slot)
+{
+    std::lock_guard lock(m_mutex);
+    assert(slot < m_size);
+    assert(m_used[slot]);
+    m_used[slot] = false;
+    m_free_slots.push_back(slot);
+}
+
+} // namespace iuring
@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+ * @file FixedFileTable.hpp
+ * @brief Defines the FixedFileTable, the slot allocator for the ring's
+ * registered (fixed) file table.
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace iuring
+{
+/** Keeps track of which slots of the sparse registered file table are in
+ * use. The kernel side is set up with io_uring_register_files_sparse(),
+ * slots are filled by accept_direct or io_uring_register_files_update()
+ * and emptied by close_direct.
+ *
+ * Locked: a ring handing a socket off to another ring allocates the slot
+ * for it in the other ring's table.
+ */
+class FixedFileTable
+{
+public:
+    FixedFileTable() = default;
+
+    /** forgets all slots and makes 'size' new ones available */
+    void reset(unsigned size);
+
+    unsigned size() const
+    {
+        return m_size;
+    }
+
+    unsigned in_use() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_size - static_cast<unsigned>(m_free_slots.size());
+    }
+
+    /** @return std::nullopt if every slot is taken */
+    std::optional<unsigned> alloc();
+
+    void release(unsigned slot);
+
+private:
+    mutable std::mutex m_mutex;
+    unsigned m_size = 0;
+
+    /** lowest slot on top: keeps the kernel's file table lookups dense */
+    std::vector<unsigned> m_free_slots;
+    std::vector<bool> m_used;
+};
+
+} // namespace iuring
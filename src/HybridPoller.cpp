@@ -0,0 +1,103 @@
+#include <algorithm>
+
+#include <iuring/HybridPoller.hpp>
+
+namespace iuring
+{
+HybridPoller::HybridPoller(const std::shared_ptr<IOUringInterface>& io,
+    const HybridPollerConfig& config)
+    : m_io(io)
+    , m_config(config)
+    , m_spin_window(config.initial_spin)
+{
+    assert(m_io);
+    assert(m_config.min_spin <= m_config.max_spin);
+    m_stats.spin_window = m_spin_window;
+}
+
+
+void HybridPoller::reset_stats()
+{
+    m_stats = HybridPollerStats{};
+    m_stats.spin_window = m_spin_window;
+}
+
+
+void HybridPoller::record_completion(clock::time_point now)
+{
+    if (m_last_completion.has_value())
+    {
+        const auto sample = now - m_last_completion.value();
+        if (!m_avg_inter_arrival.has_value())
+        {
+            m_avg_inter_arrival = sample;
+        }
+        else
+        {
+            // EWMA with weight 1/8, like the kernel's RTT estimator
+            const auto avg = m_avg_inter_arrival.value();
+            m_avg_inter_arrival = avg + (sample - avg) / 8;
+        }
+
+        const auto wanted =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                m_avg_inter_arrival.value() * m_config.inter_arrival_factor);
+        const std::chrono::nanoseconds min_spin = m_config.min_spin;
+        const std::chrono::nanoseconds max_spin = m_config.max_spin;
+
+        // too sparse to catch by spinning: only spin the minimum
+        m_spin_window =
+            wanted > max_spin ? min_spin : std::max(wanted, min_spin);
+        m_stats.spin_window = m_spin_window;
+    }
+    m_last_completion = now;
+}
+
+
+std::expected<size_t, error::Error> HybridPoller::run_once()
+{
+    const auto budget = m_io->get_active_config().completion_budget;
+
+    auto now = clock::now();
+    const auto spin_start = now;
+    const auto spin_deadline = m_last_completion.has_value() ?
+        m_last_completion.value() + m_spin_window :
+        now;
+
+    while (now < spin_deadline)
+    {
+        const auto ret = m_io->reap_completions(budget);
+        if (!ret)
+        {
+            return ret;
+        }
+
+        now = clock::now();
+        if (ret.value() > 0)
+        {
+            m_stats.spin_hits++;
+            record_completion(now);
+            return ret;
+        }
+    }
+    m_stats.wasted_spin_time += now - spin_start;
+
+    const auto ret = m_io->run_once(m_config.sleep_timeout);
+    if (!ret)
+    {
+        return ret;
+    }
+
+    if (ret.value() > 0)
+    {
+        m_stats.sleep_wakeups++;
+        record_completion(clock::now());
+    }
+    else
+    {
+        m_stats.sleep_timeouts++;
+    }
+    return ret;
+}
+
+} // namespace iuring
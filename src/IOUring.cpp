@@ -6,9 +6,11 @@
 #include <netdb.h>
 #include <sys/mman.h>
 
-
+#include <algorithm>
+#include <bit>
 #include <thread>
 
+#include "ControlMessages.hpp"
 #include "IOUring.hpp"
 #include "ProbeUringFeatures.hpp"
 #include "SocketImpl.hpp"
@@ -18,19 +20,23 @@ namespace iuring
 {
 namespace
 {
-    // global instance to help with signal handler callback
-    std::shared_ptr<IOUring> s_self;
+    /** getaddrinfo_a() notifies us on a thread of its own, this maps each
+     * outstanding request back to the ring that issued it.
+     */
+    std::mutex s_resolve_owners_mutex;
+    std::map<const void*, std::weak_ptr<IOUring>> s_resolve_owners;
 } // namespace
 
 std::shared_ptr<IOUringInterface> IOUringInterface::create_impl(
-    logging::ILogger& logger, NetworkAdapter& adapter)
+    logging::ILogger& logger, NetworkAdapter& adapter,
+    const IOUringConfig& config)
 {
-    return IOUring::create(logger, adapter);
+    return IOUring::create(logger, adapter, config);
 }
 
 
-std::shared_ptr<IOUring> IOUring::create(
-    logging::ILogger& logger, NetworkAdapter& adapter, size_t queue_size)
+std::shared_ptr<IOUring> IOUring::create(logging::ILogger& logger,
+    NetworkAdapter& adapter, const IOUringConfig& config)
 {
     /** make_shared<> does not work with private ctors
      * so we inherit from it with a public ctor
@@ -40,22 +46,24 @@ std::shared_ptr<IOUring> IOUring::create(
     {
     public:
         EnableShared(logging::ILogger& logger, NetworkAdapter& adapter,
-            size_t queue_size)
-            : IOUring(logger, adapter, queue_size)
+            const IOUringConfig& config)
+            : IOUring(logger, adapter, config)
         {
         }
     };
 
-    return std::make_shared<EnableShared>(logger, adapter, queue_size);
+    return std::make_shared<EnableShared>(logger, adapter, config);
 }
 
 
-IOUring::IOUring(
-    logging::ILogger& logger, NetworkAdapter& adapter, size_t queue_size)
+IOUring::IOUring(logging::ILogger& logger, NetworkAdapter& adapter,
+    const IOUringConfig& config)
     : m_logger(logger)
-    , m_queue_size(queue_size)
+    , m_config(config)
+    , m_active_config(config)
     , m_adapter(adapter)
     , m_pool(logger)
+    , m_send_arena(logger)
 {
 }
 
@@ -67,141 +75,712 @@ IOUring::~IOUring()
 
 error::Error IOUring::init()
 {
-    init_ring();
+    if (auto ret = init_ring(); ret != error::Error::OK)
+    {
+        return ret;
+    }
 
-    probe_features();
+    if (auto ret = probe_features(); ret != error::Error::OK)
+    {
+        return ret;
+    }
+    setup_fixed_files();
+    setup_send_arena();
 
     auto ret = setup_buffer_pool();
+    m_leases =
+        std::make_shared<BufferLeaseQueue>(m_active_config.max_buffer_leases);
     m_initialized = true;
     return ret;
 }
 
-void IOUring::init_ring()
+namespace
 {
-    if (false)
+    /** removes combinations the kernel rejects no matter its version */
+    void sanitize_config(IOUringConfig& config, logging::ILogger& logger)
     {
-        struct io_uring_params params;
-        memset(&params, 0, sizeof(params));
-        params.cq_entries = QD * 8;
-        params.flags =
-            // IORING_SETUP_IOPOLL | // only for storage
-            IORING_SETUP_SUBMIT_ALL |    //
-            IORING_SETUP_COOP_TASKRUN |  //
-            IORING_SETUP_SINGLE_ISSUER | //
-            IORING_SETUP_DEFER_TASKRUN | //
-            IORING_SETUP_CQSIZE |        //
-            0;
-
-        if (const auto ret = io_uring_queue_init_params(QD, &m_ring, &params);
-            ret < 0)
+        if (config.defer_taskrun && !config.single_issuer)
         {
-            LOG_ERROR(get_logger(),
-                "queue_init failed: {}\n"
-                "NB: This requires a kernel version >= 6.0",
-                strerror(-ret));
-            abort();
+            LOG_INFO(logger, "DEFER_TASKRUN requires SINGLE_ISSUER, enabling it");
+            config.single_issuer = true;
         }
 
-        if (1)
+        if (config.sqpoll && (config.coop_taskrun || config.defer_taskrun))
         {
-            auto ret = io_uring_register_ring_fd(&m_ring);
-            if (ret < 0)
-            {
-                LOG_ERROR(get_logger(), "register_ring_fd: {}", strerror(-ret));
-                abort();
-            }
+            LOG_INFO(logger,
+                "SQPOLL does not combine with COOP_TASKRUN/DEFER_TASKRUN, "
+                "disabling those");
+            config.coop_taskrun = false;
+            config.defer_taskrun = false;
+        }
+
+        if (!config.sqpoll && config.sq_thread_cpu.has_value())
+        {
+            LOG_INFO(logger, "sq_thread_cpu ignored without SQPOLL");
+            config.sq_thread_cpu.reset();
+        }
+
+        if (config.direct_accept && config.fixed_file_slots == 0)
+        {
+            LOG_INFO(logger, "direct_accept ignored without fixed_file_slots");
+            config.direct_accept = false;
+        }
 
-            ret = io_uring_close_ring_fd(&m_ring);
-            if (ret < 0)
+        if (config.buffer_groups.empty())
+        {
+            config.buffer_groups.emplace_back();
+        }
+        for (auto& group : config.buffer_groups)
+        {
+            const auto count = std::bit_ceil(std::clamp(group.count, 1U, 32768U));
+            if (count != group.count)
             {
-                LOG_ERROR(get_logger(), "close_ring_fd: {}\n", strerror(-ret));
-                abort();
+                LOG_INFO(logger, "buffer group of {} buffers rounded to {}",
+                    group.count, count);
+                group.count = count;
             }
         }
+
+        if (config.cq_entries != 0 && config.cq_entries < config.queue_size)
+        {
+            LOG_INFO(logger, "cq_entries {} < queue_size {}, using queue_size",
+                config.cq_entries, config.queue_size);
+            config.cq_entries = config.queue_size;
+        }
     }
-    else
+
+    io_uring_params make_params(const IOUringConfig& config)
     {
-        if (const auto ret = io_uring_queue_init(m_queue_size, &m_ring, 0);
-            ret != 0)
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+
+        // IORING_SETUP_IOPOLL is only for storage
+        if (config.submit_all)
         {
-            LOG_ERROR(
-                get_logger(), "io_uring_queue_init: {}\n", strerror(-ret));
-            abort();
+            params.flags |= IORING_SETUP_SUBMIT_ALL;
+        }
+        if (config.coop_taskrun)
+        {
+            params.flags |= IORING_SETUP_COOP_TASKRUN;
+        }
+        if (config.single_issuer)
+        {
+            params.flags |= IORING_SETUP_SINGLE_ISSUER;
+        }
+        if (config.defer_taskrun)
+        {
+            params.flags |= IORING_SETUP_DEFER_TASKRUN;
+        }
+        if (config.coop_taskrun || config.defer_taskrun)
+        {
+            // lets liburing see pending task work when we peek the CQ
+            params.flags |= IORING_SETUP_TASKRUN_FLAG;
+        }
+        if (config.sqpoll)
+        {
+            params.flags |= IORING_SETUP_SQPOLL;
+            params.sq_thread_idle = config.sq_thread_idle_ms;
+        }
+        if (config.sq_thread_cpu.has_value())
+        {
+            params.flags |= IORING_SETUP_SQ_AFF;
+            params.sq_thread_cpu = config.sq_thread_cpu.value();
+        }
+        if (config.cq_entries != 0)
+        {
+            params.flags |= IORING_SETUP_CQSIZE;
+            params.cq_entries = config.cq_entries;
+        }
+        return params;
+    }
+
+    /** switches off the most recently added (least likely supported) mode.
+     * @return the name of that mode, or nullptr if nothing is left to drop.
+     */
+    const char* drop_newest_mode(IOUringConfig& config)
+    {
+        if (config.defer_taskrun)
+        {
+            config.defer_taskrun = false;
+            return "DEFER_TASKRUN";
+        }
+        if (config.single_issuer)
+        {
+            config.single_issuer = false;
+            return "SINGLE_ISSUER";
+        }
+        if (config.coop_taskrun)
+        {
+            config.coop_taskrun = false;
+            return "COOP_TASKRUN";
+        }
+        if (config.submit_all)
+        {
+            config.submit_all = false;
+            return "SUBMIT_ALL";
+        }
+        if (config.sq_thread_cpu.has_value())
+        {
+            config.sq_thread_cpu.reset();
+            return "SQ_AFF";
+        }
+        if (config.sqpoll)
+        {
+            config.sqpoll = false;
+            return "SQPOLL";
+        }
+        if (config.cq_entries != 0)
+        {
+            config.cq_entries = 0;
+            return "CQSIZE";
         }
+        return nullptr;
+    }
+} // namespace
+
+error::Error IOUring::init_ring()
+{
+    auto config = m_config;
+    sanitize_config(config, get_logger());
+
+    while (true)
+    {
+        auto params = make_params(config);
+        const auto ret =
+            io_uring_queue_init_params(config.queue_size, &m_ring, &params);
+        if (ret == 0)
+        {
+            break;
+        }
+
+        // EINVAL: unknown flag, EPERM: SQPOLL without privileges on < 5.11
+        const char* dropped = nullptr;
+        if (ret == -EINVAL || ret == -EPERM)
+        {
+            dropped = drop_newest_mode(config);
+        }
+
+        if (!dropped)
+        {
+            LOG_ERROR(get_logger(), "io_uring_queue_init_params: {}\n",
+                strerror(-ret));
+            return error::errno_to_error(-ret);
+        }
+
+        LOG_INFO(get_logger(), "kernel rejected {} ({}), falling back",
+            dropped, strerror(-ret));
+    }
+
+    m_active_config = config;
+
+    const auto features = m_ring.features;
+    m_capabilities.set_feature_bits(features);
+    m_capabilities.set(Capability::NODROP, features & IORING_FEAT_NODROP);
+    m_capabilities.set(Capability::FAST_POLL, features & IORING_FEAT_FAST_POLL);
+    m_capabilities.set(Capability::EXT_ARG, features & IORING_FEAT_EXT_ARG);
+#ifdef IORING_FEAT_RECVSEND_BUNDLE
+    m_capabilities.set(
+        Capability::RECVSEND_BUNDLE, features & IORING_FEAT_RECVSEND_BUNDLE);
+#endif
+
+    if (auto ret = check_nodrop(); ret != error::Error::OK)
+    {
+        return ret;
+    }
+
+    if (m_active_config.register_ring_fd)
+    {
+        register_ring_fd();
     }
 
     io_uring_ring_dontfork(&m_ring);
+
+    LOG_INFO(get_logger(),
+        "io_uring active modes: sq={} cq={} submit_all={} coop_taskrun={} "
+        "single_issuer={} defer_taskrun={} sqpoll={} (cpu {}, idle {} ms) "
+        "registered_ring_fd={}",
+        m_ring.sq.ring_entries, m_ring.cq.ring_entries,
+        m_active_config.submit_all, m_active_config.coop_taskrun,
+        m_active_config.single_issuer, m_active_config.defer_taskrun,
+        m_active_config.sqpoll, m_active_config.sq_thread_cpu.value_or(-1),
+        m_active_config.sq_thread_idle_ms, m_active_config.register_ring_fd);
+
+    return error::Error::OK;
 }
 
+void IOUring::register_ring_fd()
+{
+    // the plain ring fd stays open: io_uring_register() calls (probing,
+    // buffer rings) still go through it on kernels < 6.3
+    if (const auto ret = io_uring_register_ring_fd(&m_ring); ret < 0)
+    {
+        LOG_ERROR(get_logger(), "register_ring_fd: {}, falling back",
+            strerror(-ret));
+        m_active_config.register_ring_fd = false;
+    }
+}
+
+error::Error IOUring::check_nodrop()
+{
+    if (m_capabilities.has(Capability::NODROP))
+    {
+        return error::Error::OK;
+    }
+
+    if (m_active_config.require_nodrop)
+    {
+        LOG_ERROR(get_logger(),
+            "kernel lacks IORING_FEAT_NODROP, CQ overflows would lose "
+            "completions. NB This requires a kernel version >= 5.5\n");
+        return error::errno_to_error(EOPNOTSUPP);
+    }
+
+    LOG_INFO(get_logger(),
+        "kernel lacks IORING_FEAT_NODROP, CQ overflows lose completions");
+    return error::Error::OK;
+}
+
+
+/** Moves completions the kernel backlogged because the CQ was full
+ * back into the CQ.
+ * @return true if there was a backlog.
+ */
+bool IOUring::flush_cq_overflow()
+{
+    const uint64_t dropped = *m_ring.cq.koverflow;
+    if (dropped != m_stats.cq_dropped)
+    {
+        LOG_ERROR(get_logger(), "CQ overflow dropped {} completions",
+            dropped - m_stats.cq_dropped);
+        m_stats.cq_dropped = dropped;
+    }
+
+    if (!io_uring_cq_has_overflow(&m_ring))
+    {
+        return false;
+    }
+
+    m_stats.cq_overflow_flushes++;
+    LOG_DEBUG(get_logger(), "CQ overflowed, flushing backlog");
+    if (const auto ret = io_uring_get_events(&m_ring); ret < 0)
+    {
+        LOG_ERROR(get_logger(), "io_uring_get_events: {}", strerror(-ret));
+        return false;
+    }
+    return true;
+}
+
+
 error::Error IOUring::setup_buffer_pool()
 {
-    buf_ring_size = (sizeof(io_uring_buf) + buffer_size()) * BUFFERS;
-    void* mapped = mmap(NULL, buf_ring_size, PROT_READ | PROT_WRITE,
-        MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
-    if (mapped == MAP_FAILED)
+    auto& groups = m_active_config.buffer_groups;
+    for (size_t bgid = 0; bgid < groups.size(); bgid++)
     {
-        LOG_ERROR(get_logger(), "buf_ring mmap: {}\n", strerror(errno));
-        return error::Error::MMAP_FAILED;
+        if (auto ret = add_buffer_group(static_cast<uint16_t>(bgid));
+            ret != error::Error::OK)
+        {
+            return ret;
+        }
+        groups[bgid].incremental = m_buffer_groups.back()->is_incremental();
     }
-    buf_ring = (struct io_uring_buf_ring*) mapped;
+    return error::Error::OK;
+}
 
-    io_uring_buf_ring_init(buf_ring);
 
-    memset(&m_reg, 0, sizeof(m_reg));
-    m_reg.ring_addr = (unsigned long) buf_ring;
-    m_reg.ring_entries = BUFFERS;
-    m_reg.bgid = 0;
-    m_reg.flags = 0;
+/** adds a buffer ring for 'size_class', its bgid is the next free one */
+error::Error IOUring::add_buffer_group(uint16_t size_class)
+{
+    const auto& config = m_active_config.buffer_groups.at(size_class);
+    const auto bgid = static_cast<uint16_t>(m_buffer_groups.size());
+
+    auto group =
+        std::make_unique<BufferGroup>(get_logger(), m_ring, size_class);
+    if (auto ret = group->init(bgid, config.buffer_size, config.count,
+            config.incremental, m_active_config.memory);
+        ret != error::Error::OK)
+    {
+        return ret;
+    }
 
-    buffer_base =
-        (unsigned char*) buf_ring + sizeof(struct io_uring_buf) * BUFFERS;
+    m_buffer_memory += BufferGroup::memory_size(config.buffer_size, config.count);
+    m_buffer_groups.push_back(std::move(group));
+    return error::Error::OK;
+}
 
-    const auto ret = io_uring_register_buf_ring(&m_ring, &m_reg, 0);
-    if (ret)
+
+/** @return BufferGroup::get_recycled() summed over the rings of a class */
+unsigned IOUring::recycled_buffers(uint16_t size_class) const
+{
+    unsigned recycled = 0;
+    for (const auto& group : m_buffer_groups)
+    {
+        if (group->get_size_class() == size_class)
+        {
+            recycled += group->get_recycled();
+        }
+    }
+    return recycled;
+}
+
+
+/** the ring a starved receive moves to: the ring of its size class with
+ * the most free buffers, else a new one if the memory cap allows it.
+ * @return std::nullopt while it has to wait for a buffer to come back:
+ * re-arming it on an empty ring would only fail with ENOBUFS again
+ */
+std::optional<uint16_t> IOUring::next_buffer_group(const WorkItem& work_item)
+{
+    const auto bgid = work_item.m_buffer_group;
+    const auto size_class = get_buffer_group(bgid).get_size_class();
+    const auto count = m_buffer_groups.size();
+
+    std::optional<uint16_t> fullest;
+    unsigned most_free = 0;
+    bool known = true;
+    for (size_t i = 0; i < count && known; i++)
+    {
+        if (m_buffer_groups[i]->get_size_class() != size_class)
+        {
+            continue;
+        }
+        const auto free = m_buffer_groups[i]->free_buffers();
+        known = free.has_value();
+        if (known && *free > most_free)
+        {
+            most_free = *free;
+            fullest = static_cast<uint16_t>(i);
+        }
+    }
+    if (known && fullest)
+    {
+        return *fullest;
+    }
+
+    const auto& config = m_active_config.buffer_groups[size_class];
+    const auto extra = BufferGroup::memory_size(config.buffer_size, config.count);
+    if (count < UINT16_MAX &&
+        m_buffer_memory + extra <= m_active_config.buffer_memory_cap &&
+        add_buffer_group(size_class) == error::Error::OK)
+    {
+        m_stats.buffer_groups_added++;
+        LOG_INFO(get_logger(),
+            "buffer group {} ran out of buffers, added group {} ({} bytes of "
+            "receive buffers now)",
+            bgid, count, m_buffer_memory);
+        return static_cast<uint16_t>(count);
+    }
+
+    if (known ||
+        recycled_buffers(size_class) == work_item.m_starved_recycled)
+    {
+        // every ring of the class is empty, or without free_buffers() none
+        // got a buffer back since the receive starved
+        return std::nullopt;
+    }
+
+    // a buffer came back to one of them, the kernel can't tell which
+    for (size_t n = 1; n <= count; n++)
+    {
+        const auto i = (bgid + n) % count;
+        if (m_buffer_groups[i]->get_size_class() == size_class)
+        {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    return bgid;
+}
+
+
+void IOUring::rearm_starved_receives()
+{
+    if (m_starved_receives.empty())
+    {
+        return;
+    }
+
+    // the batch that just ran has recycled its buffers by now
+    auto starved = std::move(m_starved_receives);
+    m_starved_receives.clear();
+    for (auto& work_item : starved)
+    {
+        const auto bgid = next_buffer_group(*work_item);
+        if (!bgid)
+        {
+            m_starved_receives.push_back(work_item);
+            if (!work_item->m_waits_for_buffer)
+            {
+                // the callbacks keep their buffers too long or the cap is
+                // too low
+                work_item->m_waits_for_buffer = true;
+                m_stats.starved_rearms++;
+                if ((m_stats.starved_rearms & (m_stats.starved_rearms - 1)) ==
+                    0)
+                {
+                    LOG_ERROR(get_logger(),
+                        "all buffer groups of size class {} are empty ({} "
+                        "times)",
+                        get_buffer_group(work_item->m_buffer_group)
+                            .get_size_class(),
+                        m_stats.starved_rearms);
+                }
+            }
+            continue;
+        }
+
+        work_item->m_waits_for_buffer = false;
+        work_item->m_buffer_group = *bgid;
+        LOG_DEBUG(get_logger(), "re-arming starved receive {} on group {}",
+            work_item->get_id(), work_item->m_buffer_group);
+        submit(*work_item);
+    }
+}
+
+/** hands the buffers of released leases back to their groups */
+void IOUring::recycle_leased_buffers()
+{
+    if (!m_leases)
+    {
+        return;
+    }
+
+    m_leases->take_released(m_released_leases);
+    for (const auto& buffer : m_released_leases)
+    {
+        get_buffer_group(buffer.m_group).release(buffer.m_idx, 0, 0);
+    }
+    m_stats.buffer_leases = m_leases->outstanding();
+    m_stats.buffer_leases_refused = m_leases->refused();
+}
+
+
+/** the incremental mode keeps filling a buffer, those can't be leased */
+LeasableBuffer IOUring::make_leasable(const BufferGroup& group, unsigned idx)
+{
+    if (group.is_incremental() || m_active_config.max_buffer_leases == 0)
+    {
+        return {};
+    }
+    return LeasableBuffer{ .m_queue = m_leases.get(),
+        .m_buffer = LeasedBuffer{ .m_group = group.get_bgid(), .m_idx = idx } };
+}
+
+
+void IOUring::setup_fixed_files()
+{
+    const auto slots = m_active_config.fixed_file_slots;
+    if (slots == 0)
+    {
+        return;
+    }
+
+    // sparse tables and accept_direct came with the same kernel (5.19)
+    if (!m_capabilities.has(Capability::MULTISHOT_ACCEPT))
+    {
+        LOG_INFO(get_logger(), "kernel too old for a sparse file table, "
+                               "not using fixed files");
+        m_active_config.fixed_file_slots = 0;
+        m_active_config.direct_accept = false;
+        return;
+    }
+
+    if (const auto ret = io_uring_register_files_sparse(&m_ring, slots);
+        ret < 0)
     {
         LOG_ERROR(get_logger(),
-            "buf_ring init failed: {}\n"
-            "NB This requires a kernel version >= 6.0\n",
+            "register_files_sparse({}): {}, not using fixed files. "
+            "NB This requires a kernel version >= 5.19\n",
+            slots, strerror(-ret));
+        m_active_config.fixed_file_slots = 0;
+        m_active_config.direct_accept = false;
+        return;
+    }
+
+    m_fixed_files.reset(slots);
+    LOG_INFO(get_logger(), "registered file table with {} slots (direct "
+        "accept: {})", slots, m_active_config.direct_accept);
+}
+
+
+error::Error IOUring::register_fixed_socket(
+    const std::shared_ptr<ISocket>& socket)
+{
+    assert(socket);
+    if (socket->get_fixed_slot().has_value())
+    {
+        return error::Error::OK;
+    }
+
+    const auto slot = m_fixed_files.alloc();
+    if (!slot)
+    {
+        LOG_ERROR(get_logger(), "no free fixed file slot for socket {}",
+            socket->get_fd());
+        return error::errno_to_error(ENFILE);
+    }
+
+    int fd = socket->get_fd();
+    if (const auto ret = io_uring_register_files_update(&m_ring, *slot, &fd, 1);
+        ret < 0)
+    {
+        LOG_ERROR(get_logger(), "register_files_update(socket {}): {}", fd,
             strerror(-ret));
+        m_fixed_files.release(*slot);
         return error::errno_to_error(-ret);
     }
 
-    for (auto i = 0u; i < BUFFERS; i++)
+    socket->set_fixed_slot(slot);
+    return error::Error::OK;
+}
+
+
+/** empties the slot of a socket that also has a normal fd */
+void IOUring::unregister_fixed_socket(ISocket& socket)
+{
+    const auto slot = socket.get_fixed_slot();
+    assert(slot.has_value());
+    assert(socket.get_fd() >= 0);
+
+    int fd = -1;
+    if (const auto ret = io_uring_register_files_update(&m_ring, *slot, &fd, 1);
+        ret < 0)
     {
-        io_uring_buf_ring_add(buf_ring, get_buffer(i), buffer_size(), i,
-            io_uring_buf_ring_mask(BUFFERS), i);
+        LOG_ERROR(get_logger(), "failed to empty fixed file slot {}: {}", *slot,
+            strerror(-ret));
     }
-    io_uring_buf_ring_advance(buf_ring, BUFFERS / 2);
+    m_fixed_files.release(*slot);
+    socket.set_fixed_slot(std::nullopt);
+}
+
 
-    for (int i = BUFFERS / 2; i < BUFFERS; i++)
+void IOUring::setup_send_arena()
+{
+    const auto slots = m_active_config.send_arena_slots;
+    if (slots == 0)
     {
-        m_free_send_ids.push(i);
+        // zero-copy sends are only done from the arena
+        m_active_config.zero_copy_send = false;
+        return;
     }
 
-    return error::Error::OK;
+    if (!m_capabilities.has(Capability::REGISTERED_BUFFERS))
+    {
+        LOG_INFO(get_logger(), "no registered buffers, not using a send arena");
+        m_active_config.send_arena_slots = 0;
+        m_active_config.zero_copy_send = false;
+        return;
+    }
+
+    if (m_send_arena.init(slots, m_active_config.send_arena_slot_size,
+            m_active_config.memory) != error::Error::OK)
+    {
+        m_active_config.send_arena_slots = 0;
+        m_active_config.zero_copy_send = false;
+        return;
+    }
+
+    // one registered buffer (index 0) covers the whole arena
+    const auto iov = m_send_arena.get_iovec();
+    if (const auto ret = io_uring_register_buffers(&m_ring, &iov, 1); ret < 0)
+    {
+        LOG_ERROR(get_logger(),
+            "register_buffers(send arena, {} bytes): {}, sends use plain "
+            "buffers\n",
+            iov.iov_len, strerror(-ret));
+        m_active_config.send_arena_slots = 0;
+        m_active_config.zero_copy_send = false;
+        return;
+    }
+
+    if (m_active_config.zero_copy_send &&
+        !m_capabilities.has(Capability::SEND_ZC))
+    {
+        LOG_INFO(get_logger(), "kernel lacks IORING_OP_SEND_ZC, zero-copy "
+                               "sends switched off");
+        m_active_config.zero_copy_send = false;
+    }
+
+    LOG_INFO(get_logger(),
+        "send arena: {} slots of {} bytes (zero-copy from {} bytes: {})",
+        slots, m_send_arena.slot_size(), m_active_config.zero_copy_min_size,
+        m_active_config.zero_copy_send);
 }
 
-void IOUring::recycle_buffer(int idx)
+
+void IOUring::free_send_work_item(const std::shared_ptr<WorkItem>& work_item)
 {
-    io_uring_buf_ring_add(buf_ring, get_buffer(idx), buffer_size(), idx,
-        io_uring_buf_ring_mask(BUFFERS), 0);
-    io_uring_buf_ring_advance(buf_ring, 1);
+    if (work_item->m_send_slot)
+    {
+        work_item->m_send_packet.detach_storage();
+        m_send_arena.release(*work_item->m_send_slot);
+        work_item->m_send_slot.reset();
+    }
+    work_item->m_zero_copy_send = false;
+    get_pool().free_work_item(work_item->get_id());
 }
 
 
-void IOUring::probe_features()
+error::Error IOUring::probe_features()
 {
     ProbeUringFeatures probe(&m_ring, get_logger());
-    assert(probe.supports(UringFeature::IORING_OP_ACCEPT));
+
+    for (const auto op : {
+             UringFeature::IORING_OP_ACCEPT,
 #if SUPPORT_LISTEN_IN_LIBURING
-    assert(probe.supports(UringFeature::IORING_OP_LISTEN));
+             UringFeature::IORING_OP_LISTEN,
 #endif
-    assert(probe.supports(UringFeature::IORING_OP_RECV));
-    assert(probe.supports(UringFeature::IORING_OP_RECVMSG));
-    assert(probe.supports(UringFeature::IORING_OP_SEND));
-    assert(probe.supports(UringFeature::IORING_OP_SENDMSG));
-    assert(probe.supports(UringFeature::IORING_OP_CLOSE));
-    assert(probe.supports(UringFeature::IORING_OP_CONNECT));
+             UringFeature::IORING_OP_RECV,
+             UringFeature::IORING_OP_RECVMSG,
+             UringFeature::IORING_OP_SEND,
+             UringFeature::IORING_OP_SENDMSG,
+             UringFeature::IORING_OP_CLOSE,
+             UringFeature::IORING_OP_CONNECT,
+         })
+    {
+        if (!probe.supports(op))
+        {
+            LOG_ERROR(get_logger(),
+                "kernel lacks required io_uring opcode {}. "
+                "NB This requires a kernel version >= 6.0\n",
+                static_cast<int>(op));
+            return error::errno_to_error(EOPNOTSUPP);
+        }
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(UringFeature::COUNT); i++)
+    {
+        const auto op = static_cast<UringFeature>(i);
+        if (probe.supports(op))
+        {
+            m_capabilities.set_supported(op);
+        }
+    }
+
+    m_capabilities.set(Capability::MSG_RING,
+        probe.supports(UringFeature::IORING_OP_MSG_RING));
+    m_capabilities.set(
+        Capability::SEND_ZC, probe.supports(UringFeature::IORING_OP_SEND_ZC));
+    m_capabilities.set(Capability::REGISTERED_BUFFERS,
+        probe.supports(UringFeature::IORING_OP_READ_FIXED));
+    // multishot has no probe, opcodes of the same kernel release stand in
+    m_capabilities.set(Capability::MULTISHOT_ACCEPT,
+        probe.supports(UringFeature::IORING_OP_SOCKET));
+    m_capabilities.set(Capability::MULTISHOT_RECV,
+        probe.supports(UringFeature::IORING_OP_SEND_ZC));
+
+    LOG_INFO(get_logger(),
+        "io_uring capabilities: nodrop={} fast_poll={} ext_arg={} bundle={} "
+        "msg_ring={} send_zc={} multishot_accept={} multishot_recv={} "
+        "registered_buffers={}",
+        m_capabilities.has(Capability::NODROP),
+        m_capabilities.has(Capability::FAST_POLL),
+        m_capabilities.has(Capability::EXT_ARG),
+        m_capabilities.has(Capability::RECVSEND_BUNDLE),
+        m_capabilities.has(Capability::MSG_RING),
+        m_capabilities.has(Capability::SEND_ZC),
+        m_capabilities.has(Capability::MULTISHOT_ACCEPT),
+        m_capabilities.has(Capability::MULTISHOT_RECV),
+        m_capabilities.has(Capability::REGISTERED_BUFFERS));
+    return error::Error::OK;
 }
 
 
@@ -222,31 +801,173 @@ void IOUring::submit_all_requests()
 }
 
 
+/** @return nullptr if the SQ stays full even after submitting */
 io_uring_sqe* IOUring::get_sqe()
 {
     auto* sqe = io_uring_get_sqe(&m_ring);
     if (!sqe)
     {
-        LOG_ERROR(get_logger(), "sqe entry is NULL from get-sqe\n");
+        LOG_DEBUG(get_logger(), "SQ full, submitting to make room");
         submit_all_requests();
         sqe = io_uring_get_sqe(&m_ring);
     }
+    return sqe;
+}
 
-    if (!sqe)
+
+void IOUring::queue_submission(WorkItem& item)
+{
+    auto work_item = get_pool().get_work_item(item.get_id());
+    assert(work_item.get() == &item);
+    m_pending_submissions.push_back(work_item);
+
+    const auto pending = m_pending_submissions.size();
+    m_stats.submissions_queued++;
+    m_stats.pending_submissions = pending;
+    m_stats.max_pending_submissions =
+        std::max(m_stats.max_pending_submissions, pending);
+
+    if (!m_congested &&
+        pending >= m_active_config.pending_submissions_high_water)
     {
-        LOG_ERROR(get_logger(), "sqe entry is NULL from get-sqe\n");
-        abort();
+        m_congested = true;
+        m_stats.backpressure_events++;
+        LOG_INFO(get_logger(), "SQ congested, {} submissions pending", pending);
+        if (m_backpressure_handler)
+        {
+            m_backpressure_handler(
+                BackpressureStatus{ .congested = true, .pending = pending });
+        }
+    }
+}
+
+
+void IOUring::drain_pending_submissions()
+{
+    while (!m_pending_cancels.empty())
+    {
+        auto* sqe = get_sqe();
+        if (!sqe)
+        {
+            break;
+        }
+        prep_cancel(sqe, m_pending_cancels.back());
+        m_pending_cancels.pop_back();
+    }
+
+    if (m_pending_submissions.empty())
+    {
+        return;
+    }
+
+    while (!m_pending_submissions.empty())
+    {
+        auto* sqe = get_sqe();
+        if (!sqe)
+        {
+            break;
+        }
+        auto work_item = std::move(m_pending_submissions.front());
+        m_pending_submissions.pop_front();
+        prep_sqe(sqe, *work_item);
+    }
+
+    if (!m_active_config.deferred_submit)
+    {
+        submit_all_requests();
+    }
+
+    const auto pending = m_pending_submissions.size();
+    m_stats.pending_submissions = pending;
+
+    if (m_congested &&
+        pending <= m_active_config.pending_submissions_high_water / 2)
+    {
+        m_congested = false;
+        LOG_INFO(get_logger(), "SQ drained, {} submissions pending", pending);
+        if (m_backpressure_handler)
+        {
+            m_backpressure_handler(
+                BackpressureStatus{ .congested = false, .pending = pending });
+        }
     }
-    return sqe;
 }
 
 
 void IOUring::submit(IWorkItem& _item)
 {
     auto& item = dynamic_cast<WorkItem&>(_item);
-    auto* sqe = get_sqe();
+
+    if (m_multishot.get_state(item.get_id()) != MultishotState::DISARMED)
+    {
+        // a second request would deliver every completion twice
+        LOG_DEBUG(get_logger(), "{} is still armed, not submitting again",
+            item.get_descr().c_str());
+        return;
+    }
+
+    // once something waits for SQ space, everything after it waits too,
+    // that keeps linked requests in order.
+    auto* sqe = m_pending_submissions.empty() ? get_sqe() : nullptr;
+    if (!sqe)
+    {
+        queue_submission(item);
+        return;
+    }
+
+    prep_sqe(sqe, item);
+
+    if (!m_active_config.deferred_submit)
+    {
+        submit_all_requests();
+    }
+}
+
+
+/** Stops the multishot request of 'id'. Its remaining CQEs, up to the one
+ * without IORING_CQE_F_MORE, are dropped, then the work item is freed.
+ */
+void IOUring::cancel_multishot(work_item_id_t id)
+{
+    if (!m_multishot.cancel(id))
+    {
+        return;
+    }
+
+    auto* sqe = m_pending_cancels.empty() ? get_sqe() : nullptr;
+    if (!sqe)
+    {
+        m_pending_cancels.push_back(id);
+        return;
+    }
+    prep_cancel(sqe, id);
+
+    if (!m_active_config.deferred_submit)
+    {
+        submit_all_requests();
+    }
+}
+
+
+void IOUring::prep_cancel(io_uring_sqe* sqe, work_item_id_t id)
+{
+    io_uring_prep_cancel64(sqe, id, 0);
+    io_uring_sqe_set_data64(sqe, MULTISHOT_CANCEL_TAG | id);
+}
+
+
+void IOUring::prep_sqe(io_uring_sqe* sqe, WorkItem& item)
+{
     io_uring_sqe_set_data(sqe, (void*) item.m_id);
 
+    // sockets in the registered file table are addressed by their slot
+    const auto& socket = item.get_socket();
+    const auto fixed_slot =
+        socket ? socket->get_fixed_slot() : std::optional<unsigned>{};
+    const int fd = fixed_slot ? static_cast<int>(*fixed_slot) :
+        socket                ? socket->get_fd() :
+                                -1;
+
     switch (item.get_type())
     {
     default:
@@ -254,26 +975,69 @@ void IOUring::submit(IWorkItem& _item)
         abort();
 
     case WorkItem::Type::CLOSE:
-        io_uring_prep_close(sqe, item.get_socket()->get_fd());
-        break;
+        if (item.m_close_fixed_slot)
+        {
+            io_uring_prep_close_direct(sqe, *item.m_close_fixed_slot);
+        }
+        else if (fixed_slot && socket->get_fd() >= 0)
+        {
+            unregister_fixed_socket(*socket);
+            io_uring_prep_close(sqe, socket->get_fd());
+        }
+        else if (fixed_slot)
+        {
+            // the slot is released in call_close_callback()
+            io_uring_prep_close_direct(sqe, *fixed_slot);
+        }
+        else
+        {
+            io_uring_prep_close(sqe, fd);
+        }
+        // close is not an operation on the file, it never gets
+        // IOSQE_FIXED_FILE
+        return;
 
     case WorkItem::Type::ACCEPT: {
         int flags = 0;
         // flags |= IOSQE_BUFFER_SELECT;
 
-        LOG_DEBUG(
-            get_logger(), "accept on socket {}", item.get_socket()->get_fd());
+        LOG_DEBUG(get_logger(), "accept on socket {}", fd);
 
-        item.m_accept_sock_len = 0;
-        io_uring_prep_accept(sqe, item.get_socket()->get_fd(),
-            (struct sockaddr*) &item.m_buffer_for_uring,
-            &item.m_accept_sock_len, flags);
+        item.m_accept_sock_len = sizeof(item.m_buffer_for_uring);
+        item.m_multishot = false;
+        item.m_accept_fixed_slot = m_active_config.direct_accept ?
+            m_fixed_files.alloc() :
+            std::nullopt;
+        if (item.m_accept_fixed_slot)
+        {
+            io_uring_prep_accept_direct(sqe, fd,
+                (struct sockaddr*) &item.m_buffer_for_uring,
+                &item.m_accept_sock_len, flags, *item.m_accept_fixed_slot);
+        }
+        else if (!m_active_config.direct_accept &&
+            m_capabilities.has(Capability::MULTISHOT_ACCEPT))
+        {
+            // direct accepts pick their slot per request, so only plain
+            // accepts stay armed. All their completions would share one
+            // sockaddr, so the peer address comes from getpeername() instead
+            item.m_multishot = true;
+            io_uring_prep_multishot_accept(sqe, fd, nullptr, nullptr, flags);
+        }
+        else
+        {
+            if (m_active_config.direct_accept)
+            {
+                LOG_DEBUG(get_logger(), "fixed file table full, plain accept");
+            }
+            io_uring_prep_accept(sqe, fd,
+                (struct sockaddr*) &item.m_buffer_for_uring,
+                &item.m_accept_sock_len, flags);
+        }
         break;
     }
 
     case WorkItem::Type::CONNECT: {
         assert(item.m_connect_sock_len > 0);
-        const auto fd = item.get_socket()->get_fd();
 
         sockaddr_in* sa = (sockaddr_in*) &item.m_buffer_for_uring;
 
@@ -296,11 +1060,35 @@ void IOUring::submit(IWorkItem& _item)
         if (item.is_stream())
         {
             int flags = 0;
-            LOG_DEBUG(
-                get_logger(), " register rcv: {}", item.get_socket()->get_fd());
-            io_uring_prep_recv(sqe, item.get_socket()->get_fd(),
-                nullptr, // buffer selected automatically from buffer queue
-                buffer_size(), flags);
+            LOG_DEBUG(get_logger(), " register rcv: {}", fd);
+            auto& group = get_buffer_group(item.m_buffer_group);
+
+            // incremental buffers already pack several receives together
+            item.m_bundle = item.has_batch_callback() &&
+                m_capabilities.has(Capability::RECVSEND_BUNDLE) &&
+                !group.is_incremental();
+#ifndef IORING_RECVSEND_BUNDLE
+            item.m_bundle = false;
+#endif
+            item.m_multishot = m_capabilities.has(Capability::MULTISHOT_RECV);
+            if (item.m_multishot)
+            {
+                // stays armed, each chunk gets a CQE with IORING_CQE_F_MORE
+                io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, flags);
+            }
+            else
+            {
+                // a bundle of length 0 takes as many buffers as it fills
+                io_uring_prep_recv(sqe, fd,
+                    nullptr, // buffer selected automatically from buffer queue
+                    item.m_bundle ? 0 : group.buffer_size(), flags);
+            }
+#ifdef IORING_RECVSEND_BUNDLE
+            if (item.m_bundle)
+            {
+                sqe->ioprio |= IORING_RECVSEND_BUNDLE;
+            }
+#endif
         }
         else
         {
@@ -321,25 +1109,56 @@ void IOUring::submit(IWorkItem& _item)
             item.m_msg.msg_iov->iov_base =
                 nullptr; // selects a buffer automatically from buffer-queue
 
-            io_uring_prep_recvmsg_multishot(
-                sqe, item.get_socket()->get_fd(), &item.m_msg, MSG_TRUNC);
+            // multishot puts the control messages in the buffer as well
+            const bool error_queue = item.is_error_queue_receive();
+            item.m_msg.msg_controllen = error_queue ?
+                error_queue_control_space() :
+                receive_control_space(socket->get_receive_controls());
+            const int flags = error_queue ? MSG_ERRQUEUE : MSG_TRUNC;
+
+            item.m_multishot = m_capabilities.has(Capability::MULTISHOT_RECV);
+            if (item.m_multishot)
+            {
+                io_uring_prep_recvmsg_multishot(sqe, fd, &item.m_msg, flags);
+            }
+            else
+            {
+                if (item.m_msg.msg_controllen > 0)
+                {
+                    assert(item.m_msg.msg_controllen <= item.m_control.size());
+                    item.m_msg.msg_control = item.m_control.data();
+                }
+                item.m_msg.msg_iov->iov_len =
+                    get_buffer_group(item.m_buffer_group).buffer_size();
+                io_uring_prep_recvmsg(sqe, fd, &item.m_msg, flags);
+            }
         }
 
         sqe->flags |= IOSQE_BUFFER_SELECT;
-        sqe->buf_group = 0;
+        sqe->buf_group = item.m_buffer_group;
         break;
     }
 
     case WorkItem::Type::SEND_STREAM_DATA: {
-        const auto fd = item.get_socket()->get_fd();
-
         assert(item.is_stream());
         int flags = 0;
         const auto& sp = item.get_raw_send_packet();
 
         LOG_DEBUG(get_logger(), "sending {} bytes ({})", sp.size(),
             (char*) sp.data());
-        io_uring_prep_send(sqe, fd, sp.data(), sp.size(), flags);
+        item.m_zero_copy_send = m_active_config.zero_copy_send &&
+            item.m_send_slot &&
+            sp.size() >= m_active_config.zero_copy_min_size;
+        if (item.m_zero_copy_send)
+        {
+            // the arena is registered buffer 0: no page pinning per send
+            io_uring_prep_send_zc_fixed(
+                sqe, fd, sp.data(), sp.size(), flags, 0, 0);
+        }
+        else
+        {
+            io_uring_prep_send(sqe, fd, sp.data(), sp.size(), flags);
+        }
 
         if (item.next_request_should_wait_for_this_request())
         {
@@ -348,16 +1167,42 @@ void IOUring::submit(IWorkItem& _item)
         break;
     }
 
-    case WorkItem::Type::SEND_WORKPACKET: {
-        const auto fd = item.get_socket()->get_fd();
+    case WorkItem::Type::MSG_RING: {
+        if (item.m_ring_msg_source_slot)
+        {
+            io_uring_prep_msg_ring_fd(sqe, item.m_target_ring_fd,
+                *item.m_ring_msg_source_slot, *item.m_ring_msg_target_slot,
+                item.m_ring_msg_data, 0);
+        }
+        else
+        {
+            io_uring_prep_msg_ring(sqe, item.m_target_ring_fd,
+                item.m_ring_msg_len, item.m_ring_msg_data, 0);
+        }
+        // targets the other ring's fd, not the socket
+        return;
+    }
 
+    case WorkItem::Type::SEND_WORKPACKET: {
         assert(!item.is_stream());
         int flags = 0;
         LOG_DEBUG(get_logger(), "SEND ---- submit: {}", fd);
+        if (item.m_params.tx_timestamp)
+        {
+            item.m_tx_timestamp_id = socket->next_tx_timestamp_id();
+            item.m_tx_timestamp_generation =
+                socket->get_tx_timestamp_generation();
+            item.m_tx_id_per_packet = socket->has_per_packet_tx_id();
+            if (!item.m_tx_timestamp_id)
+            {
+                LOG_ERROR(get_logger(), "socket {} sends with tx_timestamp "
+                                        "before enable_tx_timestamps()",
+                    fd);
+            }
+        }
         item.init_send_msg();
         io_uring_prep_sendmsg(sqe, fd, &item.m_msg, flags);
 
-        // sqe->flags |= IOSQE_FIXED_FILE;
         // sqe->flags |= IOSQE_BUFFER_SELECT;
 
         if (item.next_request_should_wait_for_this_request())
@@ -368,7 +1213,16 @@ void IOUring::submit(IWorkItem& _item)
     }
     }
 
-    submit_all_requests();
+    if (fixed_slot)
+    {
+        sqe->flags |= IOSQE_FIXED_FILE;
+    }
+
+    if (item.m_multishot)
+    {
+        [[maybe_unused]] const bool armed = m_multishot.arm(item.m_id);
+        assert(armed);
+    }
 }
 
 
@@ -391,12 +1245,23 @@ void WorkItem::init_send_msg()
         const int32_t ttl =
             static_cast<std::underlying_type_t<timetolive_t>>(m_params.ttl);
         assert(ttl > 0 && ttl < 256);
+        const uint32_t timestamping = SOF_TIMESTAMPING_TX_SOFTWARE;
 
         m_control.fill(0);
 
         m_msg.msg_control = m_control.data();
         m_msg.msg_controllen =
             CMSG_SPACE(sizeof(tos)) + CMSG_SPACE(sizeof(ttl));
+        if (m_tx_timestamp_id)
+        {
+            m_msg.msg_controllen += CMSG_SPACE(sizeof(timestamping));
+        }
+#ifdef SCM_TS_OPT_ID
+        if (m_tx_timestamp_id && m_tx_id_per_packet)
+        {
+            m_msg.msg_controllen += CMSG_SPACE(sizeof(uint32_t));
+        }
+#endif
         assert(m_msg.msg_controllen < m_control.size());
 
         auto* cmsgptr = CMSG_FIRSTHDR(&m_msg);
@@ -413,6 +1278,30 @@ void WorkItem::init_send_msg()
         cmsgptr->cmsg_type = IP_TTL;
         cmsgptr->cmsg_len = CMSG_LEN(sizeof(ttl));
         memcpy(CMSG_DATA(cmsgptr), &ttl, sizeof(ttl));
+
+        if (m_tx_timestamp_id)
+        {
+            // the socket was set up with OPT_ID by enable_tx_timestamps()
+            cmsgptr = CMSG_NXTHDR(&m_msg, cmsgptr);
+            assert(cmsgptr);
+            cmsgptr->cmsg_level = SOL_SOCKET;
+            cmsgptr->cmsg_type = SO_TIMESTAMPING;
+            cmsgptr->cmsg_len = CMSG_LEN(sizeof(timestamping));
+            memcpy(CMSG_DATA(cmsgptr), &timestamping, sizeof(timestamping));
+        }
+#ifdef SCM_TS_OPT_ID
+        if (m_tx_timestamp_id && m_tx_id_per_packet)
+        {
+            // the kernel uses our id, no matter how many sends failed
+            const uint32_t id = *m_tx_timestamp_id;
+            cmsgptr = CMSG_NXTHDR(&m_msg, cmsgptr);
+            assert(cmsgptr);
+            cmsgptr->cmsg_level = SOL_SOCKET;
+            cmsgptr->cmsg_type = SCM_TS_OPT_ID;
+            cmsgptr->cmsg_len = CMSG_LEN(sizeof(id));
+            memcpy(CMSG_DATA(cmsgptr), &id, sizeof(id));
+        }
+#endif
     }
 
     m_msg.msg_flags = 0;
@@ -442,6 +1331,28 @@ void IOUring::call_close_callback(
 {
     const int status = cqe->res;
     LOG_DEBUG(get_logger(), "=======> CLOSE CALLBACK: {}", cqe->res);
+
+    // the slot of a socket that was handed off to another ring
+    if (const auto slot = work_item->m_close_fixed_slot; slot.has_value())
+    {
+        if (status < 0)
+        {
+            LOG_ERROR(get_logger(), "close_direct of slot {} failed: {}",
+                *slot, strerror(-status));
+        }
+        m_fixed_files.release(*slot);
+        return;
+    }
+
+    // close_direct: the slot is empty now
+    const auto& socket = work_item->get_socket();
+    if (const auto slot = socket->get_fixed_slot(); slot.has_value())
+    {
+        assert(socket->get_fd() < 0);
+        m_fixed_files.release(*slot);
+        socket->set_fixed_slot(std::nullopt);
+    }
+
     work_item->call_close_callback(status);
 }
 
@@ -464,6 +1375,36 @@ void IOUring::call_send_callback(
     work_item->call_send_callback(cqe->res);
 }
 
+/** A timestamped send failed, so the kernel did not count it.
+ * @return true if the send was submitted again because the kernel
+ * rejected its per-packet id (SCM_TS_OPT_ID)
+ */
+bool IOUring::resync_tx_timestamp_ids(
+    const std::shared_ptr<WorkItem>& work_item, io_uring_cqe* cqe)
+{
+    const auto& socket = work_item->get_socket();
+    if (work_item->m_tx_id_per_packet)
+    {
+        if (cqe->res != -EINVAL || !socket->has_per_packet_tx_id())
+        {
+            // the id was in the packet, nothing to count
+            return false;
+        }
+        LOG_INFO(get_logger(),
+            "kernel lacks SCM_TS_OPT_ID, socket {} counts TX timestamp ids",
+            socket->get_fd());
+        socket->disable_per_packet_tx_id();
+        socket->resync_tx_timestamp_ids();
+        submit(*work_item);
+        return true;
+    }
+
+    // every id given out after this send is one too high now
+    socket->resync_tx_timestamp_ids();
+    return false;
+}
+
+
 void IOUring::call_connect_callback(
     std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe)
 {
@@ -504,80 +1445,484 @@ void IOUring::call_connect_callback(
 void IOUring::call_accept_callback(
     std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe)
 {
-    // if (!(cqe->flags & IORING_CQE_F_BUFFER) || cqe->res < 0)
+    const auto fixed_slot = work_item->m_accept_fixed_slot;
+    work_item->m_accept_fixed_slot.reset();
+
+    // if (!(cqe->flags & IORING_CQE_F_BUFFER) || cqe->res < 0)
+    if (cqe->res < 0)
+    {
+        if (fixed_slot)
+        {
+            m_fixed_files.release(*fixed_slot);
+        }
+
+        LOG_ERROR(get_logger(), "recv cqe bad res {} ({})", cqe->res,
+            strerror(-cqe->res));
+        if (cqe->res == -EFAULT || cqe->res == -EINVAL)
+        {
+            LOG_ERROR(
+                get_logger(), "NB: This requires a kernel version >= 6.0\n");
+        }
+        return;
+    }
+
+    // accept_direct into a chosen slot returns 0, there is no normal fd
+    const int fd = fixed_slot ? -1 : cqe->res;
+
+    LOG_DEBUG(get_logger(), " XQE - res = {}", cqe->res);
+
+    iuring::IPAddress addr;
+    if (!work_item->m_multishot)
+    {
+        addr = iuring::IPAddress(
+            work_item->m_buffer_for_uring, work_item->m_accept_sock_len);
+    }
+    else
+    {
+        sockaddr_storage peer{};
+        socklen_t peer_len = sizeof(peer);
+        if (getpeername(fd, (struct sockaddr*) &peer, &peer_len) == 0)
+        {
+            addr = iuring::IPAddress(peer, peer_len);
+        }
+        else
+        {
+            LOG_ERROR(get_logger(), "getpeername on accepted {} failed: {}",
+                fd, strerror(errno));
+        }
+    }
+    const AcceptResult new_conn{
+        .m_new_fd = fd, .m_address = addr, .m_fixed_slot = fixed_slot
+    };
+
+    work_item->call_accept_callback(new_conn);
+}
+
+
+/** completion of our own MSG_RING request, on the sending ring */
+void IOUring::call_msg_ring_callback(
+    std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe)
+{
+    if (cqe->res >= 0)
+    {
+        // the target has its own reference to the file now
+        if (const auto slot = work_item->m_ring_msg_source_slot)
+        {
+            get_pool().alloc_close_direct_work_item(
+                shared_from_this(), *slot, "handoff-close");
+        }
+        return;
+    }
+
+    LOG_ERROR(get_logger(), "msg_ring to ring fd {} failed: {}",
+        work_item->m_target_ring_fd, strerror(-cqe->res));
+
+    // the target never saw the socket, so we still own it
+    if (work_item->m_ring_msg_data & SOCKET_HANDOFF_TAG)
+    {
+        auto* handoff = reinterpret_cast<SocketHandoff*>(
+            work_item->m_ring_msg_data & ~USER_DATA_TAG_MASK);
+        if (handoff->m_fixed_slot)
+        {
+            handoff->m_target->m_fixed_files.release(*handoff->m_fixed_slot);
+        }
+        delete handoff;
+    }
+}
+
+
+/** a message posted by another ring, on the receiving ring */
+void IOUring::call_ring_message_handler(io_uring_cqe* cqe)
+{
+    const auto user_data = io_uring_cqe_get_data64(cqe);
+    const auto value = user_data & ~USER_DATA_TAG_MASK;
+
+    if (user_data & SOCKET_HANDOFF_TAG)
+    {
+        auto* handoff = reinterpret_cast<SocketHandoff*>(value);
+        const std::shared_ptr<ISocket> socket = std::move(handoff->m_socket);
+        // only its fd, or only its slot in our table
+        socket->set_fixed_slot(handoff->m_fixed_slot);
+        delete handoff;
+
+        if (!m_socket_handoff_handler)
+        {
+            LOG_ERROR(get_logger(), "no handoff handler set, dropping socket {}",
+                socket->get_fd());
+            return;
+        }
+        m_socket_handoff_handler(socket);
+        return;
+    }
+
+    if (!m_ring_message_handler)
+    {
+        LOG_ERROR(get_logger(), "no ring message handler set, dropping message");
+        return;
+    }
+
+    const RingMessage msg{ .m_type = static_cast<uint32_t>(cqe->res),
+        .m_value = value };
+    m_ring_message_handler(msg);
+}
+
+
+ReceivePostAction IOUring::call_recv_handler_stream(const uint8_t* buffer,
+    std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe,
+    LeasableBuffer* leasable)
+{
+    IPAddress source_addr;
+    const auto payload_length = cqe->res;
+
+    LOG_DEBUG(get_logger(), "size = {}\n", (int) payload_length);
+
+    ReceivedMessage payload(buffer, payload_length, source_addr, leasable);
+
+    if (work_item->has_batch_callback())
+    {
+        return work_item->call_recv_batch_callback(
+            std::span<const ReceivedMessage>(&payload, 1));
+    }
+    return work_item->call_recv_callback(payload);
+}
+
+
+void IOUring::handle_receive_action(
+    const std::shared_ptr<WorkItem>& work_item, ReceivePostAction action)
+{
+    const auto id = work_item->get_id();
+    // a multishot receive is still armed until a CQE without MORE, a
+    // starved one is armed again by rearm_starved_receives()
+    const bool armed = m_multishot.get_state(id) == MultishotState::ARMED;
+    const bool starved =
+        std::ranges::find(m_starved_receives, work_item) !=
+        m_starved_receives.end();
+
+    switch (action)
+    {
+    case ReceivePostAction::NONE:
+        if (armed)
+        {
+            // freed with the last CQE of the cancelled request
+            cancel_multishot(id);
+        }
+        else
+        {
+            std::erase(m_starved_receives, work_item);
+            get_pool().free_work_item(id);
+        }
+        break;
+    case ReceivePostAction::RE_SUBMIT:
+        if (!armed && !starved)
+        {
+            submit(*work_item);
+        }
+        break;
+    }
+}
+
+
+std::shared_ptr<WorkItem> IOUring::find_batched_work_item(
+    work_item_id_t id) const
+{
+    for (size_t i = 0; i < m_active_batches; i++)
+    {
+        if (m_receive_batches[i].m_work_item->get_id() == id)
+        {
+            return m_receive_batches[i].m_work_item;
+        }
+    }
+    return nullptr;
+}
+
+
+void IOUring::queue_batched_receive(
+    const std::shared_ptr<WorkItem>& work_item, io_uring_cqe* cqe)
+{
+    ReceiveBatch* batch = nullptr;
+    for (size_t i = 0; i < m_active_batches && !batch; i++)
+    {
+        if (m_receive_batches[i].m_work_item == work_item)
+        {
+            batch = &m_receive_batches[i];
+        }
+    }
+    if (!batch)
+    {
+        if (m_active_batches == m_receive_batches.size())
+        {
+            m_receive_batches.emplace_back();
+        }
+        batch = &m_receive_batches[m_active_batches++];
+        batch->m_work_item = work_item;
+    }
+
+    if (cqe->res < 0)
+    {
+        // ends the request, deliver_receive_batches() arms a new one
+        LOG_ERROR(get_logger(), "recv cqe bad res {} ({})", cqe->res,
+            strerror(-cqe->res));
+        return;
+    }
+
+    auto& group = get_buffer_group(work_item->m_buffer_group);
+    const auto idx = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    auto payload = parse_datagram(group.get_data(idx), *work_item, cqe, nullptr);
+
+    // the next CQE in an incrementally filled buffer starts after this one
+    const bool done = group.consume(idx, cqe->res, cqe->flags);
+    if (!payload)
+    {
+        if (done)
+        {
+            group.recycle(idx);
+        }
+        return;
+    }
+    batch->add(*payload, idx, done);
+}
+
+
+/** one callback per socket for everything it received in this pass, then
+ * the buffers go back in bulk
+ */
+void IOUring::deliver_receive_batches()
+{
+    for (size_t b = 0; b < m_active_batches; b++)
+    {
+        auto& batch = m_receive_batches[b];
+        auto& group = get_buffer_group(batch.m_work_item->m_buffer_group);
+
+        const auto messages = batch.prepare(
+            [&](unsigned idx) { return make_leasable(group, idx); });
+        auto ret = ReceivePostAction::RE_SUBMIT;
+        if (!messages.empty())
+        {
+            ret = batch.m_work_item->call_recv_batch_callback(messages);
+        }
+        batch.finish([&](unsigned idx) { group.recycle(idx); });
+
+        handle_receive_action(batch.m_work_item, ret);
+        batch.m_work_item.reset();
+    }
+    m_active_batches = 0;
+}
+
+
+/** a CQE of a cancelled multishot receive: nobody wants the data anymore */
+void IOUring::drop_cancelled_completion(
+    std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe)
+{
+    if (cqe->flags & IORING_CQE_F_BUFFER)
+    {
+        auto& group = get_buffer_group(work_item->m_buffer_group);
+        auto idx = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        size_t remaining = std::max(cqe->res, 0);
+        do
+        {
+            // a bundle used several buffers
+            const auto len = std::min(remaining, group.buffer_size());
+            const auto next = group.next_in_ring(idx);
+            group.release(idx, len, cqe->flags);
+            remaining -= len;
+            idx = next;
+        } while (work_item->m_bundle && remaining > 0);
+    }
+
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+    {
+        LOG_DEBUG(get_logger(), "multishot {} cancelled",
+            work_item->get_descr().c_str());
+        get_pool().free_work_item(work_item->get_id());
+    }
+}
+
+
+/** A bundle fills the buffers in ring order, all but the last one
+ * completely, the CQE only names the first.
+ */
+ReceivePostAction IOUring::call_recv_handler_bundle(
+    std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe)
+{
+    auto& group = get_buffer_group(work_item->m_buffer_group);
+    const IPAddress source_addr;
+
+    m_bundle_messages.clear();
+    m_bundle_buffers.clear();
+    m_bundle_leasables.clear();
+
+    auto idx = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    size_t remaining = cqe->res;
+    while (remaining > 0)
+    {
+        m_bundle_buffers.push_back(idx);
+        m_bundle_leasables.push_back(make_leasable(group, idx));
+        remaining -= std::min(remaining, group.buffer_size());
+        idx = group.next_in_ring(idx);
+    }
+
+    // the leasables don't move anymore
+    remaining = cqe->res;
+    for (size_t i = 0; i < m_bundle_buffers.size(); i++)
+    {
+        const auto len = std::min(remaining, group.buffer_size());
+        m_bundle_messages.emplace_back(group.get_data(m_bundle_buffers[i]),
+            len, source_addr, &m_bundle_leasables[i]);
+        remaining -= len;
+    }
+
+    LOG_DEBUG(get_logger(), "bundle of {} bytes in {} buffers", cqe->res,
+        m_bundle_buffers.size());
+
+    const auto ret = work_item->call_recv_batch_callback(m_bundle_messages);
+    for (size_t i = 0; i < m_bundle_buffers.size(); i++)
+    {
+        if (!m_bundle_leasables[i].m_leased)
+        {
+            group.release(m_bundle_buffers[i], m_bundle_messages[i].get_size(),
+                cqe->flags);
+        }
+    }
+    // from here on only the leases hold their buffers
+    m_bundle_leasables.clear();
+    return ret;
+}
+
+
+/** calls 'visit' for each control message of a completed recvmsg, multishot
+ * ones have them in 'buffer', single-shot ones in the work item
+ */
+template <typename F>
+void IOUring::for_each_control_message(
+    const uint8_t* buffer, WorkItem& work_item, io_uring_cqe* cqe, F&& visit)
+{
+    auto& msg = work_item.m_msg;
+    if (msg.msg_controllen == 0)
+    {
+        return;
+    }
+
+    if (!work_item.m_multishot)
+    {
+        if (msg.msg_flags & MSG_CTRUNC)
+        {
+            LOG_DEBUG(get_logger(), "control messages truncated");
+        }
+        for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+             cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            visit(*cmsg);
+        }
+        return;
+    }
+
+    auto* out = io_uring_recvmsg_validate((void*) buffer, cqe->res, &msg);
+    if (!out)
+    {
+        return;
+    }
+    if (out->flags & MSG_CTRUNC)
+    {
+        LOG_DEBUG(get_logger(), "control messages truncated");
+    }
+    for (auto* cmsg = io_uring_recvmsg_cmsg_firsthdr(out, &msg); cmsg;
+         cmsg = io_uring_recvmsg_cmsg_nexthdr(out, &msg, cmsg))
+    {
+        visit(*cmsg);
+    }
+}
+
+
+/** a completion of the error queue receive, see enable_tx_timestamps() */
+void IOUring::call_tx_timestamp_callback(
+    std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe)
+{
     if (cqe->res < 0)
     {
-        LOG_ERROR(get_logger(), "recv cqe bad res {} ({})", cqe->res,
+        LOG_ERROR(get_logger(), "error queue recv failed: {}",
             strerror(-cqe->res));
-        if (cqe->res == -EFAULT || cqe->res == -EINVAL)
-        {
-            LOG_ERROR(
-                get_logger(), "NB: This requires a kernel version >= 6.0\n");
-        }
+        return;
+    }
+    if (!(cqe->flags & IORING_CQE_F_BUFFER))
+    {
+        LOG_ERROR(get_logger(), "error queue recv without a buffer");
         return;
     }
 
-    const int fd = cqe->res;
-
-    LOG_DEBUG(get_logger(), " XQE - res = {}", fd);
+    auto& group = get_buffer_group(work_item->m_buffer_group);
+    const auto idx = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
 
-    const iuring::IPAddress addr(
-        work_item->m_buffer_for_uring, work_item->m_accept_sock_len);
-    const AcceptResult new_conn{ .m_new_fd = fd, .m_address = addr };
+    TxTimestampParts parts;
+    for_each_control_message(group.get_data(idx), *work_item, cqe,
+        [&](const cmsghdr& cmsg) { parse_error_queue_message(cmsg, parts); });
+    group.release(idx, cqe->res, cqe->flags);
 
-    work_item->call_accept_callback(new_conn);
+    if (!parts.m_id || !parts.m_timestamp)
+    {
+        LOG_DEBUG(get_logger(), "error queue message without TX timestamp");
+        return;
+    }
+    work_item->call_tx_timestamp_callback(TxTimestamp{ .m_id = *parts.m_id,
+        .m_generation =
+            work_item->get_socket()->get_tx_timestamp_generation(),
+        .m_timestamp = *parts.m_timestamp });
 }
 
 
-ReceivePostAction IOUring::call_recv_handler_stream(const uint8_t* buffer,
-    std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe)
+ReceivePostAction IOUring::call_recv_handler_datagram(const uint8_t* buffer,
+    std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe,
+    LeasableBuffer* leasable)
 {
-    IPAddress source_addr;
-    const auto payload_length = cqe->res;
-
-    LOG_DEBUG(get_logger(), "size = {}\n", (int) payload_length);
-
-    ReceivedMessage payload(buffer, payload_length, source_addr);
-
-    return work_item->call_recv_callback(payload);
+    const auto payload = parse_datagram(buffer, *work_item, cqe, leasable);
+    if (!payload)
+    {
+        return ReceivePostAction::RE_SUBMIT;
+    }
+    return work_item->call_recv_callback(*payload);
 }
 
 
-ReceivePostAction IOUring::call_recv_handler_datagram(const uint8_t* buffer,
-    std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe)
+/** @return std::nullopt if the datagram has to be dropped */
+std::optional<ReceivedMessage> IOUring::parse_datagram(const uint8_t* buffer,
+    WorkItem& work_item, io_uring_cqe* cqe, LeasableBuffer* leasable)
 {
     if (!(cqe->flags & IORING_CQE_F_BUFFER))
     {
         LOG_ERROR(get_logger(), "recv cqe bad res {}", cqe->res);
         abort();
-        return ReceivePostAction::RE_SUBMIT;
+        return std::nullopt;
+    }
+
+    if (!work_item.m_multishot)
+    {
+        return parse_datagram_single(buffer, work_item, cqe, leasable);
     }
 
     auto* recv_msg_out =
-        io_uring_recvmsg_validate((void*) buffer, cqe->res, &work_item->m_msg);
+        io_uring_recvmsg_validate((void*) buffer, cqe->res, &work_item.m_msg);
     if (!recv_msg_out)
     {
         LOG_ERROR(get_logger(), "bad recvmsg - no recv_msg_out\n");
 
-        return ReceivePostAction::RE_SUBMIT;
+        return std::nullopt;
     }
 
     if (recv_msg_out->namelen > sizeof(sockaddr_storage))
     {
         LOG_ERROR(get_logger(), "truncated name\n");
 
-        return ReceivePostAction::RE_SUBMIT;
+        return std::nullopt;
     }
 
     if (recv_msg_out->flags & MSG_TRUNC)
     {
         const auto r = io_uring_recvmsg_payload_length(
-            recv_msg_out, cqe->res, &work_item->m_msg);
+            recv_msg_out, cqe->res, &work_item.m_msg);
 
         LOG_ERROR(get_logger(), "truncated msg need {} received {}",
             recv_msg_out->payloadlen, r);
 
-        return ReceivePostAction::RE_SUBMIT;
+        return std::nullopt;
     }
 
     iuring::IPAddress source_addr;
@@ -603,21 +1948,68 @@ ReceivePostAction IOUring::call_recv_handler_datagram(const uint8_t* buffer,
     }
 
     const auto payload_length = io_uring_recvmsg_payload_length(
-        recv_msg_out, cqe->res, &work_item->m_msg);
+        recv_msg_out, cqe->res, &work_item.m_msg);
 
     LOG_DEBUG(get_logger(),
         "io_uring: received {} bytes (namelen = {}) from {}", payload_length,
-        work_item->m_msg.msg_namelen,
+        work_item.m_msg.msg_namelen,
         source_addr.to_human_readable_string().c_str());
 
 
     auto* ptr =
-        (uint8_t*) io_uring_recvmsg_payload(recv_msg_out, &work_item->m_msg);
+        (uint8_t*) io_uring_recvmsg_payload(recv_msg_out, &work_item.m_msg);
     assert(ptr);
 
-    ReceivedMessage payload(ptr, payload_length, source_addr);
+    ReceivedMessage payload(ptr, payload_length, source_addr, leasable);
+    for_each_control_message(buffer, work_item, cqe, [&](const cmsghdr& cmsg) {
+        parse_control_message(cmsg, payload.m_metadata);
+    });
+    return payload;
+}
 
-    return work_item->call_recv_callback(payload);
+
+/** Without multishot the kernel fills in msghdr as for recvmsg(2), the
+ * selected buffer only holds the payload.
+ */
+std::optional<ReceivedMessage> IOUring::parse_datagram_single(
+    const uint8_t* buffer, WorkItem& work_item, io_uring_cqe* cqe,
+    LeasableBuffer* leasable)
+{
+    const auto& msg = work_item.m_msg;
+    if (msg.msg_flags & MSG_TRUNC)
+    {
+        LOG_ERROR(get_logger(), "truncated msg, received {}", cqe->res);
+        return std::nullopt;
+    }
+
+    iuring::IPAddress source_addr;
+    switch (msg.msg_namelen)
+    {
+    case 0:
+    case sizeof(sockaddr_in):
+        source_addr = IPAddress(
+            *reinterpret_cast<const sockaddr_in*>(&work_item.m_buffer_for_uring));
+        break;
+
+    case sizeof(sockaddr_in6):
+        source_addr = IPAddress(*reinterpret_cast<const sockaddr_in6*>(
+            &work_item.m_buffer_for_uring));
+        break;
+
+    default: {
+        LOG_ERROR(get_logger(), "namelen = {}", msg.msg_namelen);
+        abort();
+    }
+    }
+
+    LOG_DEBUG(get_logger(), "io_uring: received {} bytes from {}", cqe->res,
+        source_addr.to_human_readable_string().c_str());
+
+    ReceivedMessage payload(buffer, cqe->res, source_addr, leasable);
+    for_each_control_message(buffer, work_item, cqe, [&](const cmsghdr& cmsg) {
+        parse_control_message(cmsg, payload.m_metadata);
+    });
+    return payload;
 }
 
 
@@ -649,20 +2041,37 @@ ReceivePostAction IOUring::call_recv_callback(
         return ReceivePostAction::RE_SUBMIT;
     }
 
-    const auto idx = cqe->flags >> 16;
-    auto* buffer = get_buffer(idx);
+    if (work_item->is_stream() && !(cqe->flags & IORING_CQE_F_BUFFER))
+    {
+        // end of stream, no buffer was used
+        return call_recv_handler_stream(nullptr, work_item, cqe, nullptr);
+    }
+
+    if (work_item->m_bundle)
+    {
+        return call_recv_handler_bundle(work_item, cqe);
+    }
 
+    auto& group = get_buffer_group(work_item->m_buffer_group);
+    const auto idx = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    auto* buffer = group.get_data(idx);
+    auto leasable = make_leasable(group, idx);
 
     ReceivePostAction ret;
     if (work_item->is_stream())
     {
-        ret = call_recv_handler_stream(buffer, work_item, cqe);
+        ret = call_recv_handler_stream(buffer, work_item, cqe, &leasable);
     }
     else
     {
-        ret = call_recv_handler_datagram(buffer, work_item, cqe);
+        ret = call_recv_handler_datagram(buffer, work_item, cqe, &leasable);
+    }
+
+    // a leased buffer comes back through recycle_leased_buffers()
+    if (!leasable.m_leased)
+    {
+        group.release(idx, cqe->res, cqe->flags);
     }
-    recycle_buffer(idx);
     return ret;
 }
 
@@ -672,7 +2081,35 @@ void IOUring::call_callback_and_free_work_item_id(io_uring_cqe* cqe)
     const auto recv_status = cqe->res;
     const auto id = (work_item_id_t) io_uring_cqe_get_data(cqe);
 
-    auto work_item = get_pool().get_work_item(id);
+    if (id == LIBURING_UDATA_TIMEOUT)
+    {
+        // liburing's own timeout for waits on kernels without EXT_ARG
+        return;
+    }
+
+    if ((id & USER_DATA_TAG_MASK) == MULTISHOT_CANCEL_TAG)
+    {
+        // the cancelled request ends with its own CQE
+        if (cqe->res < 0 && cqe->res != -ENOENT && cqe->res != -EALREADY)
+        {
+            LOG_ERROR(get_logger(), "multishot cancel of {} failed: {}",
+                id & ~USER_DATA_TAG_MASK, strerror(-cqe->res));
+        }
+        return;
+    }
+
+    if (id & USER_DATA_TAG_MASK)
+    {
+        call_ring_message_handler(cqe);
+        return;
+    }
+
+    // a burst for the same socket saves the pool lookup (and its lock)
+    auto work_item = find_batched_work_item(id);
+    if (!work_item)
+    {
+        work_item = get_pool().get_work_item(id);
+    }
     if (!work_item)
     {
         LOG_ERROR(get_logger(),
@@ -682,28 +2119,48 @@ void IOUring::call_callback_and_free_work_item_id(io_uring_cqe* cqe)
     }
     assert(work_item);
 
+    const bool more = cqe->flags & IORING_CQE_F_MORE;
+    if (work_item->m_multishot &&
+        m_multishot.on_completion(id, more) == MultishotState::CANCELLING)
+    {
+        drop_cancelled_completion(work_item, cqe);
+        return;
+    }
+
     if (cqe->res == -ENOBUFS)
     {
+        m_stats.enobufs++;
+        if (work_item->get_type() == WorkItem::Type::RECV)
+        {
+            // without a new receive the socket would stay deaf for good
+            work_item->m_starved_recycled = recycled_buffers(
+                get_buffer_group(work_item->m_buffer_group).get_size_class());
+            m_starved_receives.push_back(work_item);
+            return;
+        }
+
         LOG_ERROR(get_logger(),
             "uring ---> ENOBUFS buffer??? -- status: {} ({})", recv_status,
             work_item->get_descr().c_str());
         return;
     }
 
-    if (cqe->flags & IORING_CQE_F_MORE)
+    if (cqe->flags & IORING_CQE_F_NOTIF)
     {
-        LOG_DEBUG(get_logger(), "NOTE: more completion events to follow ({})",
-            work_item->get_descr().c_str());
-        // return;
+        // the kernel is done with the buffer of a zero-copy send
+        free_send_work_item(work_item);
+        return;
     }
 
-
     switch (work_item->get_type())
     {
     case WorkItem::Type::ACCEPT:
         call_accept_callback(work_item, cqe);
-        // try accept again:
-        submit(*work_item);
+        // try accept again, unless the multishot accept is still armed:
+        if (!(work_item->m_multishot && more))
+        {
+            submit(*work_item);
+        }
         break;
 
     case WorkItem::Type::CLOSE:
@@ -712,16 +2169,19 @@ void IOUring::call_callback_and_free_work_item_id(io_uring_cqe* cqe)
         break;
 
     case WorkItem::Type::RECV: {
-        auto ret = call_recv_callback(work_item, cqe);
-        switch (ret)
+        if (work_item->is_error_queue_receive())
         {
-        case ReceivePostAction::NONE:
-            get_pool().free_work_item(id);
+            call_tx_timestamp_callback(work_item, cqe);
+            handle_receive_action(work_item, ReceivePostAction::RE_SUBMIT);
             break;
-        case ReceivePostAction::RE_SUBMIT:
-            submit(*work_item);
+        }
+        if (work_item->has_batch_callback() && !work_item->is_stream())
+        {
+            // delivered by deliver_receive_batches() at the end of the pass
+            queue_batched_receive(work_item, cqe);
             break;
         }
+        handle_receive_action(work_item, call_recv_callback(work_item, cqe));
         break;
     }
 
@@ -732,7 +2192,22 @@ void IOUring::call_callback_and_free_work_item_id(io_uring_cqe* cqe)
 
     case WorkItem::Type::SEND_STREAM_DATA:
     case WorkItem::Type::SEND_WORKPACKET:
+        if (cqe->res < 0 && work_item->m_tx_timestamp_id &&
+            resync_tx_timestamp_ids(work_item, cqe))
+        {
+            // sent again without the per-packet id
+            break;
+        }
         call_send_callback(work_item, cqe);
+        // zero-copy: the IORING_CQE_F_NOTIF completion frees it
+        if (!(work_item->m_zero_copy_send && (cqe->flags & IORING_CQE_F_MORE)))
+        {
+            free_send_work_item(work_item);
+        }
+        break;
+
+    case WorkItem::Type::MSG_RING:
+        call_msg_ring_callback(work_item, cqe);
         get_pool().free_work_item(id);
         break;
 
@@ -748,42 +2223,157 @@ void IOUring::send_packet(const std::shared_ptr<WorkItem>& work_item)
 }
 
 
+error::Error IOUring::flush()
+{
+    drain_pending_submissions();
+
+    if (io_uring_sq_ready(&m_ring) == 0)
+    {
+        return error::Error::OK;
+    }
+
+    const auto ret = io_uring_submit(&m_ring);
+    if (ret < 0)
+    {
+        LOG_ERROR(get_logger(), "failed to submit sqe: {}", strerror(-ret));
+        return error::errno_to_error(-ret);
+    }
+    return error::Error::OK;
+}
+
+
+/** one io_uring_enter for everything queued since the previous poll,
+ * it also runs deferred task work so the completions become visible.
+ */
+error::Error IOUring::submit_pending_and_get_events()
+{
+    if (io_uring_sq_ready(&m_ring) == 0)
+    {
+        return error::Error::OK;
+    }
+
+    const auto ret = io_uring_submit_and_get_events(&m_ring);
+    if (ret < 0)
+    {
+        LOG_ERROR(get_logger(), "failed to submit sqe: {}", strerror(-ret));
+        return error::errno_to_error(-ret);
+    }
+    return error::Error::OK;
+}
+
+
 error::Error IOUring::poll_completion_queues()
 {
-    if (false)
+    const auto ret = reap_completions(m_active_config.completion_budget);
+    if (!ret)
     {
-        // fprintf(stderr, "waiting for incoming msgs\n");
-        const auto ret = io_uring_submit(&m_ring);
-        if (ret < 0)
+        return ret.error();
+    }
+    return error::Error::OK;
+}
+
+
+std::expected<size_t, error::Error> IOUring::reap_completions(size_t budget)
+{
+    recycle_leased_buffers();
+    drain_pending_submissions();
+
+    if (m_active_config.deferred_submit)
+    {
+        if (auto ret = submit_pending_and_get_events();
+            ret != error::Error::OK)
         {
-            perror("failed to io-submit");
-            return error::Error::UNKNOWN;
+            return std::unexpected(ret);
         }
     }
 
-    // no loop around this to get more bandwidth.
-    // We are optimizing for latency/reliable execution of this task.
+    // With budget 1 we handle a single CQE and return, optimizing for
+    // latency/reliable execution of that one task.
+    // Larger budgets drain the CQ in batches and advance it once per batch.
+    std::array<io_uring_cqe*, REAP_BATCH> cqes;
+    size_t processed = 0;
+    bool flushed_overflow = false;
+    while (processed < budget)
+    {
+        const auto wanted =
+            static_cast<unsigned>(std::min(budget - processed, cqes.size()));
+        const auto count =
+            io_uring_peek_batch_cqe(&m_ring, cqes.data(), wanted);
+
+        for (unsigned i = 0; i < count; i++)
+        {
+            call_callback_and_free_work_item_id(cqes[i]);
+        }
+        io_uring_cq_advance(&m_ring, count);
+        processed += count;
 
-    io_uring_cqe* cqe = nullptr;
-    const auto success = io_uring_peek_cqe(&m_ring, &cqe);
-    switch (success)
+        if (count < wanted)
+        {
+            // the CQ is empty now, the kernel may still hold completions
+            // that did not fit in it.
+            if (!flushed_overflow && flush_cq_overflow())
+            {
+                flushed_overflow = true;
+                continue;
+            }
+            break;
+        }
+    }
+
+    deliver_receive_batches();
+    rearm_starved_receives();
+    return processed;
+}
+
+std::expected<size_t, error::Error> IOUring::wait_for_completions(
+    size_t min_events, std::chrono::microseconds timeout)
+{
+    drain_pending_submissions();
+
+    if (io_uring_sq_ready(&m_ring) == 0 &&
+        io_uring_cq_ready(&m_ring) >= min_events)
     {
-    case 0:
-        // fprintf(stderr, "peek successful!\n");
+        return io_uring_cq_ready(&m_ring);
+    }
 
-        call_callback_and_free_work_item_id(cqe);
-        io_uring_cq_advance(&m_ring, 1);
-        break;
+    const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    __kernel_timespec ts{};
+    ts.tv_sec = secs.count();
+    ts.tv_nsec =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - secs)
+            .count();
 
-    case -EAGAIN:
+    io_uring_cqe* cqe = nullptr;
+    const auto ret = io_uring_submit_and_wait_timeout(
+        &m_ring, &cqe, static_cast<unsigned>(min_events), &ts, nullptr);
+    switch (ret)
+    {
+    case -ETIME:
+    case -EINTR:
         break;
 
     default:
-        LOG_ERROR(get_logger(), "failed: {}\n", strerror(-success));
-        abort();
+        if (ret < 0)
+        {
+            LOG_ERROR(get_logger(), "failed to wait for completions: {}",
+                strerror(-ret));
+            return std::unexpected(error::errno_to_error(-ret));
+        }
         break;
     }
-    return error::Error::OK;
+    return io_uring_cq_ready(&m_ring);
+}
+
+
+std::expected<size_t, error::Error> IOUring::run_once(
+    std::chrono::microseconds timeout)
+{
+    const auto ready = wait_for_completions(1, timeout);
+    if (!ready)
+    {
+        return ready;
+    }
+    return reap_completions(m_active_config.completion_budget);
 }
 
 void IOUring::submit_accept(
@@ -806,10 +2396,56 @@ void IOUring::submit_connect(const std::shared_ptr<ISocket>& socket,
 
 void IOUring::submit_recv(
     const std::shared_ptr<ISocket>& socket, recv_callback_func_t handler)
+{
+    submit_recv(socket, handler, socket->get_buffer_group());
+}
+
+void IOUring::submit_recv(const std::shared_ptr<ISocket>& socket,
+    recv_callback_func_t handler, uint16_t buffer_group)
+{
+    assert(m_initialized);
+    assert(buffer_group < m_buffer_groups.size());
+    get_pool().alloc_recv_work_item(socket, shared_from_this(), handler,
+        buffer_group, "read-from-socket");
+}
+
+void IOUring::submit_recv_bundle(
+    const std::shared_ptr<ISocket>& socket, recv_batch_callback_func_t handler)
+{
+    assert(m_initialized);
+    assert(socket->is_stream());
+    get_pool().alloc_recv_work_item(socket, shared_from_this(), handler,
+        socket->get_buffer_group(), "read-bundle-from-socket");
+}
+
+error::Error IOUring::enable_tx_timestamps(
+    const std::shared_ptr<ISocket>& socket, tx_timestamp_callback_func_t handler)
+{
+    assert(m_initialized);
+    assert(!socket->is_stream());
+    if (auto ret = socket->enable_tx_timestamps(); ret != error::Error::OK)
+    {
+        return ret;
+    }
+    get_pool().alloc_tx_timestamp_work_item(
+        socket, shared_from_this(), handler, "read-tx-timestamps");
+    return error::Error::OK;
+}
+
+void IOUring::submit_recv_batch(
+    const std::shared_ptr<ISocket>& socket, recv_batch_callback_func_t handler)
 {
     assert(m_initialized);
-    get_pool().alloc_recv_work_item(
-        socket, shared_from_this(), handler, "read-from-socket");
+    assert(!socket->is_stream());
+    if (m_active_config.completion_budget <= 1)
+    {
+        LOG_INFO(get_logger(),
+            "submit_recv_batch() with a completion_budget of {}: every batch "
+            "is a single datagram",
+            m_active_config.completion_budget);
+    }
+    get_pool().alloc_recv_work_item(socket, shared_from_this(), handler,
+        socket->get_buffer_group(), "read-batch-from-socket");
 }
 
 std::shared_ptr<IWorkItem> IOUring::ackuire_send_workitem(
@@ -818,6 +2454,21 @@ std::shared_ptr<IWorkItem> IOUring::ackuire_send_workitem(
     assert(m_initialized);
     auto item = get_pool().alloc_send_work_item(
         socket, shared_from_this(), "write-from-socket");
+
+    if (m_active_config.send_arena_slots > 0)
+    {
+        if (const auto slot = m_send_arena.alloc(); slot.has_value())
+        {
+            item->m_send_slot = slot;
+            item->m_send_packet.attach_storage(
+                m_send_arena.get_slot(*slot), m_send_arena.slot_size());
+        }
+        else
+        {
+            // the packet allocates its own buffer on first use
+            m_stats.send_arena_exhausted++;
+        }
+    }
     return item;
 }
 
@@ -830,12 +2481,111 @@ void IOUring::submit_close(
 }
 
 
+void IOUring::send_ring_message(const std::shared_ptr<IOUringInterface>& target,
+    const std::shared_ptr<ISocket>& socket, uint32_t len, uint64_t data,
+    const char* descr)
+{
+    assert(m_initialized);
+    assert(target);
+    const auto& target_ring = dynamic_cast<const IOUring&>(*target);
+
+    get_pool().alloc_ring_message_work_item(socket, shared_from_this(),
+        target_ring.get_ring_fd(), len, data, descr);
+}
+
+
+void IOUring::post_to_ring(
+    const std::shared_ptr<IOUringInterface>& target, const RingMessage& msg)
+{
+    assert((msg.m_value & USER_DATA_TAG_MASK) == 0);
+    if (!m_capabilities.has(Capability::MSG_RING))
+    {
+        LOG_ERROR(get_logger(), "kernel lacks IORING_OP_MSG_RING, message dropped");
+        return;
+    }
+
+    send_ring_message(target, nullptr, msg.m_type,
+        msg.m_value | RING_MESSAGE_TAG, "ring-message");
+}
+
+
+void IOUring::handoff_socket(const std::shared_ptr<IOUringInterface>& target,
+    const std::shared_ptr<ISocket>& socket)
+{
+    assert(socket);
+    if (!m_capabilities.has(Capability::MSG_RING))
+    {
+        LOG_ERROR(get_logger(),
+            "kernel lacks IORING_OP_MSG_RING, socket {} stays on this ring",
+            socket->get_fd());
+        return;
+    }
+
+    auto target_ring = std::dynamic_pointer_cast<IOUring>(target);
+    assert(target_ring);
+
+    // a slot only means something in this ring's file table
+    const auto source_slot = socket->get_fixed_slot();
+    if (source_slot && socket->get_fd() >= 0)
+    {
+        unregister_fixed_socket(*socket);
+    }
+    else if (source_slot)
+    {
+        // no fd (direct accept): the file moves into a slot of the target's
+        // table, ours is closed once it arrived
+        const auto target_slot = target_ring->m_fixed_files.alloc();
+        if (!target_slot)
+        {
+            LOG_ERROR(get_logger(),
+                "target ring has no free fixed file slot, socket in slot {} "
+                "stays on this ring",
+                *source_slot);
+            return;
+        }
+
+        auto* handoff = new SocketHandoff{ .m_socket = socket,
+            .m_fixed_slot = target_slot,
+            .m_target = target_ring };
+        const auto ptr = reinterpret_cast<uint64_t>(handoff);
+        assert((ptr & USER_DATA_TAG_MASK) == 0);
+
+        get_pool().alloc_ring_fd_message_work_item(socket, shared_from_this(),
+            target_ring->get_ring_fd(), *source_slot, *target_slot,
+            ptr | SOCKET_HANDOFF_TAG, "socket-handoff");
+        return;
+    }
+
+    // rings of one process share the fd table, so the fd itself is valid on
+    // the target.
+    auto* handoff = new SocketHandoff{ .m_socket = socket,
+        .m_fixed_slot = std::nullopt,
+        .m_target = target_ring };
+    const auto ptr = reinterpret_cast<uint64_t>(handoff);
+    assert((ptr & USER_DATA_TAG_MASK) == 0);
+
+    send_ring_message(
+        target, socket, 0, ptr | SOCKET_HANDOFF_TAG, "socket-handoff");
+}
+
+
 void IOUring::sig_notifier_hostname_resolve(sigval_t sv)
 {
     void* ptr = sv.sival_ptr;
 
-    assert(s_self != nullptr);
-    s_self->trigger_hostname_resolve_callbacks(ptr);
+    std::shared_ptr<IOUring> owner;
+    {
+        std::lock_guard lock(s_resolve_owners_mutex);
+        auto it = s_resolve_owners.find(ptr);
+        assert(it != s_resolve_owners.end());
+        owner = it->second.lock();
+        s_resolve_owners.erase(it);
+    }
+
+    if (owner)
+    {
+        owner->trigger_hostname_resolve_callbacks(ptr);
+    }
 }
 
 namespace
@@ -923,10 +2673,6 @@ void IOUring::resolve_hostname(const std::string& hostname,
 
     LOG_INFO(get_logger(), "resolving hostname via DNS lookup {}", hostname.c_str());
 
-
-    s_self =
-        shared_from_this(); // safe as there should be only one IOUring instance
-
     for (auto& req : m_hostname_DNS_requests)
     {
         if (req.hostname == hostname)
@@ -953,6 +2699,11 @@ void IOUring::resolve_hostname(const std::string& hostname,
     sig.sigev_notify_function = sig_notifier_hostname_resolve;
     sig.sigev_notify_attributes = nullptr;
 
+    {
+        std::lock_guard lock(s_resolve_owners_mutex);
+        s_resolve_owners[req.request] = weak_from_this();
+    }
+
     getaddrinfo_a(GAI_NOWAIT, req.all_requests, 1, &sig);
 }
 
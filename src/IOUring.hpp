@@ -12,28 +12,32 @@
 #include <netdb.h>
 
 #include <liburing.h>
+#include <linux/net_tstamp.h>
 
+#include <deque>
 #include <expected>
-#include <stack>
+#include <vector>
 
 #include <slogger/Error.hpp>
 
 #include "iuring/IOUringInterface.hpp"
 #include "iuring/NetworkAdapter.hpp"
 
+#include "BufferGroup.hpp"
+#include "FixedFileTable.hpp"
+#include "MultishotTracker.hpp"
+#include "ReceiveBatch.hpp"
+#include "SendArena.hpp"
 #include "WorkPool.hpp"
 
-
-static constexpr size_t DEFAULT_QUEUE_SIZE = 64;
-
 namespace iuring
 {
 class IOUring : public IOUringInterface,
                 public std::enable_shared_from_this<IOUring>
 {
 private:
-    IOUring(
-        logging::ILogger& logger, NetworkAdapter& adapter, size_t queue_size);
+    IOUring(logging::ILogger& logger, NetworkAdapter& adapter,
+        const IOUringConfig& config);
 
     IOUring(const IOUring&) = delete;
     IOUring& operator=(const IOUring&) = delete;
@@ -42,14 +46,46 @@ private:
 
 public:
     static std::shared_ptr<IOUring> create(logging::ILogger& logger,
-        NetworkAdapter& adapter, size_t queue_size = DEFAULT_QUEUE_SIZE);
+        NetworkAdapter& adapter, const IOUringConfig& config = {});
 
     ~IOUring();
 
     error::Error init() override;
 
+    const IOUringConfig& get_active_config() const override
+    {
+        return m_active_config;
+    }
+
+    const IOUringCapabilities& get_capabilities() const override
+    {
+        return m_capabilities;
+    }
+
+    IOUringStats get_stats() const override
+    {
+        return m_stats;
+    }
+
+    void set_backpressure_handler(
+        backpressure_callback_func_t handler) override
+    {
+        m_backpressure_handler = handler;
+    }
+
     error::Error poll_completion_queues() override;
 
+    std::expected<size_t, error::Error> reap_completions(
+        size_t budget) override;
+
+    std::expected<size_t, error::Error> wait_for_completions(
+        size_t min_events, std::chrono::microseconds timeout) override;
+
+    std::expected<size_t, error::Error> run_once(
+        std::chrono::microseconds timeout) override;
+
+    error::Error flush() override;
+
     std::shared_ptr<IWorkItem> ackuire_send_workitem(
         const std::shared_ptr<ISocket>& socket) override;
 
@@ -62,37 +98,126 @@ public:
     void submit_recv(const std::shared_ptr<ISocket>& socket,
         recv_callback_func_t handler) override;
 
+    void submit_recv(const std::shared_ptr<ISocket>& socket,
+        recv_callback_func_t handler, uint16_t buffer_group) override;
+
+    void submit_recv_bundle(const std::shared_ptr<ISocket>& socket,
+        recv_batch_callback_func_t handler) override;
+
+    void submit_recv_batch(const std::shared_ptr<ISocket>& socket,
+        recv_batch_callback_func_t handler) override;
+
+    error::Error enable_tx_timestamps(const std::shared_ptr<ISocket>& socket,
+        tx_timestamp_callback_func_t handler) override;
+
     void submit_close(const std::shared_ptr<ISocket>& socket,
         close_callback_func_t handler) override;
 
+    error::Error register_fixed_socket(
+        const std::shared_ptr<ISocket>& socket) override;
+
     void resolve_hostname(const std::string& hostname,
         const resolve_hostname_callback_func_t& handler) override;
 
+    void post_to_ring(const std::shared_ptr<IOUringInterface>& target,
+        const RingMessage& msg) override;
+
+    void handoff_socket(const std::shared_ptr<IOUringInterface>& target,
+        const std::shared_ptr<ISocket>& socket) override;
+
+    void set_ring_message_handler(
+        ring_message_callback_func_t handler) override
+    {
+        m_ring_message_handler = handler;
+    }
+
+    void set_socket_handoff_handler(
+        socket_handoff_callback_func_t handler) override
+    {
+        m_socket_handoff_handler = handler;
+    }
+
+    int get_ring_fd() const
+    {
+        return m_ring.ring_fd;
+    }
+
     NetworkAdapter& get_adapter()
     {
         return m_adapter;
     }
 
 private:
-    static constexpr auto QD = 64;
-    static constexpr auto BUF_SHIFT = 12; /* 4k */
-    static constexpr auto CQES = (QD * 16);
-    static constexpr auto BUFFERS = CQES;
+    /** CQEs fetched per io_uring_peek_batch_cqe() call */
+    static constexpr size_t REAP_BATCH = 64;
+
+    /** user_data bits of CQEs posted by other rings (IORING_OP_MSG_RING),
+     * work item ids never get this high.
+     */
+    static constexpr uint64_t RING_MESSAGE_TAG = 1ULL << 63;
+    static constexpr uint64_t SOCKET_HANDOFF_TAG = 1ULL << 62;
+    static constexpr uint64_t USER_DATA_TAG_MASK =
+        RING_MESSAGE_TAG | SOCKET_HANDOFF_TAG;
+    /** both tags: the completion of a multishot cancel */
+    static constexpr uint64_t MULTISHOT_CANCEL_TAG = USER_DATA_TAG_MASK;
+
+    /** a socket on its way to another ring, boxed in the MSG_RING
+     * user_data. The receiving ring takes ownership of the box.
+     */
+    struct SocketHandoff
+    {
+        std::shared_ptr<ISocket> m_socket;
+        /** its slot in the target's file table, if it has no fd */
+        std::optional<unsigned> m_fixed_slot;
+        std::shared_ptr<IOUring> m_target;
+    };
 
     bool m_initialized = false;
     logging::ILogger& m_logger;
-    size_t m_queue_size = 0;
-    io_uring_buf_reg m_reg;
+    IOUringConfig m_config;
+    IOUringConfig m_active_config;
 
     io_uring m_ring{};
-    io_uring_buf_ring* buf_ring = nullptr;
-    size_t buf_ring_size = 0;
-    size_t buf_shift = BUF_SHIFT;
-    unsigned char* buffer_base = nullptr;
-    std::stack<int> m_free_send_ids;
+    /** indexed by buffer group id. The first ones are the size classes of
+     * IOUringConfig::buffer_groups, rings added on ENOBUFS follow.
+     */
+    std::vector<std::unique_ptr<BufferGroup>> m_buffer_groups;
+    size_t m_buffer_memory = 0;
+    /** receives that got ENOBUFS, armed again after the current batch */
+    std::vector<std::shared_ptr<WorkItem>> m_starved_receives;
+    /** receive buffers callbacks kept, see ReceivedMessage::take_lease() */
+    std::shared_ptr<BufferLeaseQueue> m_leases;
+    std::vector<LeasedBuffer> m_released_leases;
+
+    /** the first m_active_batches are in use, the rest keep their capacity
+     * for the next pass
+     */
+    std::vector<ReceiveBatch> m_receive_batches;
+    size_t m_active_batches = 0;
+
+    /** scratch space of call_recv_handler_bundle() */
+    std::vector<ReceivedMessage> m_bundle_messages;
+    std::vector<unsigned> m_bundle_buffers;
+    std::vector<LeasableBuffer> m_bundle_leasables;
 
     NetworkAdapter& m_adapter;
     WorkPool m_pool;
+    FixedFileTable m_fixed_files;
+    SendArena m_send_arena;
+    IOUringStats m_stats;
+
+    /** work items that did not get an SQE yet, in submission order */
+    std::deque<std::shared_ptr<WorkItem>> m_pending_submissions;
+    /** work items whose multishot cancel did not get an SQE yet */
+    std::vector<work_item_id_t> m_pending_cancels;
+
+    MultishotTracker m_multishot;
+    bool m_congested = false;
+    backpressure_callback_func_t m_backpressure_handler;
+
+    IOUringCapabilities m_capabilities;
+    ring_message_callback_func_t m_ring_message_handler;
+    socket_handoff_callback_func_t m_socket_handoff_handler;
 
     class RequestInfo
     {
@@ -146,36 +271,45 @@ private:
     }
 
     error::Error setup_buffer_pool();
-    void probe_features();
-    void init_ring();
+    error::Error add_buffer_group(uint16_t size_class);
+    unsigned recycled_buffers(uint16_t size_class) const;
+    std::optional<uint16_t> next_buffer_group(const WorkItem& work_item);
+    void rearm_starved_receives();
+    void recycle_leased_buffers();
+    LeasableBuffer make_leasable(const BufferGroup& group, unsigned idx);
+    void setup_fixed_files();
+    void setup_send_arena();
+    void unregister_fixed_socket(ISocket& socket);
+    error::Error probe_features();
+    error::Error init_ring();
+    void register_ring_fd();
+    error::Error check_nodrop();
+    bool flush_cq_overflow();
 
     void submit_all_requests();
+    error::Error submit_pending_and_get_events();
 
-    size_t buffer_size() const
-    {
-        assert(buf_shift > 0);
-        return 1U << buf_shift;
-    }
-
-    uint8_t* get_buffer(int idx)
+    BufferGroup& get_buffer_group(uint16_t bgid)
     {
-        assert(buf_shift > 0);
-        return buffer_base + (idx << buf_shift);
+        assert(bgid < m_buffer_groups.size());
+        return *m_buffer_groups[bgid];
     }
 
 
     static void sig_notifier_hostname_resolve(sigval_t sv);
     void trigger_hostname_resolve_callbacks(void* ptr);
 
-    void recycle_buffer(int idx);
-
     void submit(IWorkItem& item) override;
 
     void send_packet(const std::shared_ptr<WorkItem>& work_item);
+    void free_send_work_item(const std::shared_ptr<WorkItem>& work_item);
 
     void call_callback_and_free_work_item_id(io_uring_cqe* cqe);
 
     io_uring_sqe* get_sqe();
+    void prep_sqe(io_uring_sqe* sqe, WorkItem& item);
+    void queue_submission(WorkItem& item);
+    void drain_pending_submissions();
 
     void call_send_callback(
         std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe);
@@ -187,15 +321,50 @@ private:
         std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe);
 
     ReceivePostAction call_recv_handler_stream(const uint8_t* buffer,
+        std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe,
+        LeasableBuffer* leasable);
+
+    template <typename F>
+    void for_each_control_message(const uint8_t* buffer, WorkItem& work_item,
+        io_uring_cqe* cqe, F&& visit);
+    bool resync_tx_timestamp_ids(
+        const std::shared_ptr<WorkItem>& work_item, io_uring_cqe* cqe);
+    void call_tx_timestamp_callback(
         std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe);
-
-    ReceivePostAction call_recv_handler_datagram(const uint8_t* buffer,
+    void cancel_multishot(work_item_id_t id);
+    void handle_receive_action(
+        const std::shared_ptr<WorkItem>& work_item, ReceivePostAction action);
+    std::shared_ptr<WorkItem> find_batched_work_item(work_item_id_t id) const;
+    void queue_batched_receive(
+        const std::shared_ptr<WorkItem>& work_item, io_uring_cqe* cqe);
+    void deliver_receive_batches();
+    void prep_cancel(io_uring_sqe* sqe, work_item_id_t id);
+    void drop_cancelled_completion(
         std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe);
+    ReceivePostAction call_recv_handler_bundle(
+        std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe);
+    std::optional<ReceivedMessage> parse_datagram(const uint8_t* buffer,
+        WorkItem& work_item, io_uring_cqe* cqe, LeasableBuffer* leasable);
+    std::optional<ReceivedMessage> parse_datagram_single(
+        const uint8_t* buffer, WorkItem& work_item, io_uring_cqe* cqe,
+        LeasableBuffer* leasable);
+    ReceivePostAction call_recv_handler_datagram(const uint8_t* buffer,
+        std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe,
+        LeasableBuffer* leasable);
 
     ReceivePostAction call_recv_callback(
         std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe);
 
     void call_accept_callback(
         std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe);
+
+    void call_msg_ring_callback(
+        std::shared_ptr<WorkItem> work_item, io_uring_cqe* cqe);
+
+    void call_ring_message_handler(io_uring_cqe* cqe);
+
+    void send_ring_message(const std::shared_ptr<IOUringInterface>& target,
+        const std::shared_ptr<ISocket>& socket, uint32_t len, uint64_t data,
+        const char* descr);
 };
 } // namespace iuring
\ No newline at end of file
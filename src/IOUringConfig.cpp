@@ -0,0 +1,24 @@
+#include <iuring/IOUringConfig.hpp>
+
+namespace iuring
+{
+uint16_t IOUringConfig::find_buffer_group(size_t message_size) const
+{
+    uint16_t best = 0;
+    for (size_t i = 1; i < buffer_groups.size(); i++)
+    {
+        const auto size = buffer_groups[i].buffer_size;
+        const auto best_size = buffer_groups[best].buffer_size;
+        const bool fits = size >= message_size;
+        const bool best_fits = best_size >= message_size;
+
+        if ((fits && (!best_fits || size < best_size)) ||
+            (!fits && !best_fits && size > best_size))
+        {
+            best = static_cast<uint16_t>(i);
+        }
+    }
+    return best;
+}
+
+} // namespace iuring
@@ -0,0 +1,149 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* See feature_test_macros(7) */
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <future>
+
+#include <iuring/IOUringGroup.hpp>
+
+namespace iuring
+{
+IOUringGroup::IOUringGroup(logging::ILogger& logger, NetworkAdapter& adapter,
+    const IOUringGroupConfig& config)
+    : m_logger(logger)
+    , m_adapter(adapter)
+    , m_config(config)
+{
+    if (m_config.num_rings == 0)
+    {
+        m_config.num_rings = m_config.cpus.empty() ?
+            std::max(1U, std::thread::hardware_concurrency()) :
+            m_config.cpus.size();
+    }
+    assert(m_config.cpus.empty() || m_config.cpus.size() >= m_config.num_rings);
+}
+
+
+IOUringGroup::~IOUringGroup()
+{
+    stop();
+}
+
+
+int IOUringGroup::get_cpu(size_t ring_index) const
+{
+    if (m_config.cpus.empty())
+    {
+        return static_cast<int>(ring_index);
+    }
+    return m_config.cpus[ring_index];
+}
+
+
+std::shared_ptr<ISocket> IOUringGroup::create_listener(
+    SocketType type, SocketPortID port)
+{
+    return ISocket::create_impl(
+        type, port, m_logger, SocketKind::SERVER_STREAM_SOCKET, true);
+}
+
+
+error::Error IOUringGroup::start(const ring_setup_func_t& setup)
+{
+    assert(!m_running);
+    assert(m_threads.empty());
+
+    m_running = true;
+    m_rings.resize(m_config.num_rings);
+
+    std::vector<std::future<error::Error>> ready;
+    for (size_t i = 0; i < m_config.num_rings; i++)
+    {
+        std::promise<error::Error> initialized;
+        ready.push_back(initialized.get_future());
+
+        m_threads.emplace_back(
+            [this, i, setup, initialized = std::move(initialized)]() mutable {
+                const int cpu = get_cpu(i);
+
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                if (int err = pthread_setaffinity_np(
+                        pthread_self(), sizeof(set), &set);
+                    err != 0)
+                {
+                    LOG_ERROR(get_logger(), "ring {}: failed to pin to cpu {}: {}",
+                        i, cpu, strerror(err));
+                }
+
+                // the ring is created on its own thread so that
+                // SINGLE_ISSUER/DEFER_TASKRUN see the right submitter
+                auto io = IOUringInterface::create_impl(
+                    get_logger(), m_adapter, m_config.ring_config);
+                const auto ret = io->init();
+                if (ret != error::Error::OK)
+                {
+                    initialized.set_value(ret);
+                    return;
+                }
+
+                m_rings[i] = io;
+                setup(i, io);
+                initialized.set_value(error::Error::OK);
+
+                run_ring(i);
+            });
+    }
+
+    auto result = error::Error::OK;
+    for (size_t i = 0; i < ready.size(); i++)
+    {
+        if (const auto ret = ready[i].get(); ret != error::Error::OK)
+        {
+            LOG_ERROR(get_logger(), "ring {} failed to initialize", i);
+            result = ret;
+        }
+    }
+
+    if (result != error::Error::OK)
+    {
+        stop();
+    }
+    return result;
+}
+
+
+void IOUringGroup::run_ring(size_t ring_index)
+{
+    auto& io = m_rings[ring_index];
+    LOG_INFO(get_logger(), "ring {} running on cpu {}", ring_index,
+        get_cpu(ring_index));
+
+    while (m_running)
+    {
+        if (const auto ret = io->run_once(m_config.poll_timeout); !ret)
+        {
+            LOG_ERROR(get_logger(), "ring {}: run_once failed", ring_index);
+        }
+    }
+}
+
+
+void IOUringGroup::stop()
+{
+    m_running = false;
+    for (auto& t : m_threads)
+    {
+        if (t.joinable())
+        {
+            t.join();
+        }
+    }
+    m_threads.clear();
+}
+
+} // namespace iuring
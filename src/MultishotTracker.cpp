@@ -0,0 +1,46 @@
+#include "MultishotTracker.hpp"
+
+namespace iuring
+{
+bool MultishotTracker::arm(uint64_t id)
+{
+    return m_states.try_emplace(id, MultishotState::ARMED).second;
+}
+
+
+MultishotState MultishotTracker::on_completion(uint64_t id, bool more)
+{
+    const auto it = m_states.find(id);
+    if (it == m_states.end())
+    {
+        return MultishotState::DISARMED;
+    }
+
+    const auto state = it->second;
+    if (!more)
+    {
+        m_states.erase(it);
+    }
+    return state;
+}
+
+
+bool MultishotTracker::cancel(uint64_t id)
+{
+    const auto it = m_states.find(id);
+    if (it == m_states.end() || it->second != MultishotState::ARMED)
+    {
+        return false;
+    }
+    it->second = MultishotState::CANCELLING;
+    return true;
+}
+
+
+MultishotState MultishotTracker::get_state(uint64_t id) const
+{
+    const auto it = m_states.find(id);
+    return it == m_states.end() ? MultishotState::DISARMED : it->second;
+}
+
+} // namespace iuring
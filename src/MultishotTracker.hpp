@@ -0,0 +1,56 @@
+#pragma once
+
+/**
+ * @file MultishotTracker.hpp
+ * @brief Defines the MultishotTracker, the lifecycle of the ring's
+ * multishot requests.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace iuring
+{
+enum class MultishotState
+{
+    /** no request in the kernel, e.g. after the last CQE */
+    DISARMED,
+    /** the kernel posts CQEs with IORING_CQE_F_MORE until it ends */
+    ARMED,
+    /** a cancel was sent, the CQEs until the last one are dropped */
+    CANCELLING
+};
+
+/** One multishot request per work item: arm() refuses a second one while
+ * the first is still armed, a new one may only be armed after the CQE
+ * without IORING_CQE_F_MORE.
+ */
+class MultishotTracker
+{
+public:
+    /** @return false if 'id' already has a request in the kernel */
+    bool arm(uint64_t id);
+
+    /** a CQE of 'id' arrived, 'more' is its IORING_CQE_F_MORE flag.
+     * @return the state the CQE was posted in: deliver it if ARMED, drop
+     * it if CANCELLING. Work items without a tracked request are DISARMED.
+     */
+    MultishotState on_completion(uint64_t id, bool more);
+
+    /** @return true if 'id' was armed and a cancel has to be sent */
+    bool cancel(uint64_t id);
+
+    MultishotState get_state(uint64_t id) const;
+
+    /** number of requests armed or being cancelled */
+    size_t size() const
+    {
+        return m_states.size();
+    }
+
+private:
+    std::unordered_map<uint64_t, MultishotState> m_states;
+};
+
+} // namespace iuring
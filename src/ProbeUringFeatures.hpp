@@ -1,5 +1,7 @@
 #pragma once
 
+#include <iuring/IOUringCapabilities.hpp>
+
 namespace iuring
 {
     class ProbeUringFeatures
@@ -93,6 +95,12 @@ public:
             return UringFeature::IORING_OP_SYMLINKAT;
         case IORING_OP_LINKAT:
             return UringFeature::IORING_OP_LINKAT;
+        case IORING_OP_MSG_RING:
+            return UringFeature::IORING_OP_MSG_RING;
+        case IORING_OP_SEND_ZC:
+            return UringFeature::IORING_OP_SEND_ZC;
+        case IORING_OP_SOCKET:
+            return UringFeature::IORING_OP_SOCKET;
         }
         return UringFeature::UNKNOWN;
     }
@@ -104,8 +112,9 @@ public:
         m_probe = io_uring_get_probe_ring(ring);
         if (! m_probe)
         {
+            // kernels < 5.6: every supports() call says no
             LOG_ERROR(m_logger, "failed to probe uring features\n");
-            abort();
+            return;
         }
 
         for (size_t i = 0; i < m_probe->ops_len; i++)
@@ -120,22 +129,31 @@ public:
 
             // fprintf(stderr, "supported: op: {}\n", op);
             const auto ec = convert_uring_op_to_feature(op);
-            m_features[ec] = true;
+            m_features.set_supported(ec);
         }
     }
 
     bool supports(UringFeature f) const
     {
-        return m_features.contains(f);
+        return m_features.supports(f);
+    }
+
+    const IOUringCapabilities& get_features() const
+    {
+        return m_features;
     }
 
     ~ProbeUringFeatures()
     {
-        io_uring_free_probe(m_probe);
+        if (m_probe)
+        {
+            io_uring_free_probe(m_probe);
+        }
     }
 
 private:
-    std::map<UringFeature, bool> m_features;
+    /** only the opcode part is filled in */
+    IOUringCapabilities m_features;
     logging::ILogger& m_logger;
     io_uring_probe* m_probe;
 };
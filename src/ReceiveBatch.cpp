@@ -0,0 +1,19 @@
+#include "ReceiveBatch.hpp"
+
+namespace iuring
+{
+void ReceiveBatch::add(const ReceivedMessage& msg, unsigned idx, bool done)
+{
+    m_messages.push_back(msg);
+    m_buffers.push_back(Buffer{ .m_idx = idx, .m_done = done });
+}
+
+
+void ReceiveBatch::clear()
+{
+    m_messages.clear();
+    m_buffers.clear();
+    m_leasables.clear();
+}
+
+} // namespace iuring
@@ -0,0 +1,97 @@
+#pragma once
+
+/**
+ * @file ReceiveBatch.hpp
+ * @brief Defines the ReceiveBatch, the datagrams of one submit_recv_batch()
+ * receive that are delivered in one callback.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <iuring/BufferLease.hpp>
+#include <iuring/ReceivedMessage.hpp>
+
+namespace iuring
+{
+class WorkItem;
+
+/** Collects the datagrams of a socket during a poll pass. The buffers are
+ * consumed as their CQEs come in, so an incrementally filled buffer gives
+ * each CQE its own data, but only go back to their group after the
+ * callback, in CQE order.
+ */
+class ReceiveBatch
+{
+public:
+    std::shared_ptr<WorkItem> m_work_item;
+
+    bool empty() const
+    {
+        return m_messages.empty();
+    }
+
+    size_t size() const
+    {
+        return m_messages.size();
+    }
+
+    /** @param done the kernel is done with buffer 'idx' too (no
+     * IORING_CQE_F_BUF_MORE), it goes back to its group after the callback
+     */
+    void add(const ReceivedMessage& msg, unsigned idx, bool done);
+
+    /** points every message at the LeasableBuffer 'make_leasable(idx)'
+     * returns for its buffer
+     */
+    template <typename F>
+    std::span<const ReceivedMessage> prepare(F&& make_leasable)
+    {
+        // the leasables don't move anymore once all are added
+        m_leasables.clear();
+        for (const auto& buffer : m_buffers)
+        {
+            m_leasables.push_back(make_leasable(buffer.m_idx));
+        }
+        for (size_t i = 0; i < m_messages.size(); i++)
+        {
+            m_messages[i].m_leasable = &m_leasables[i];
+        }
+        return m_messages;
+    }
+
+    /** calls 'recycle(idx)' for the finished buffers no callback leased, in
+     * CQE order, and empties the batch
+     */
+    template <typename F> void finish(F&& recycle)
+    {
+        for (size_t i = 0; i < m_buffers.size(); i++)
+        {
+            const bool leased =
+                i < m_leasables.size() && m_leasables[i].m_leased;
+            if (m_buffers[i].m_done && !leased)
+            {
+                recycle(m_buffers[i].m_idx);
+            }
+        }
+        clear();
+    }
+
+    /** forgets the messages, keeps the capacity for the next pass */
+    void clear();
+
+private:
+    struct Buffer
+    {
+        unsigned m_idx;
+        bool m_done;
+    };
+
+    std::vector<ReceivedMessage> m_messages;
+    std::vector<Buffer> m_buffers;
+    std::vector<LeasableBuffer> m_leasables;
+};
+
+} // namespace iuring
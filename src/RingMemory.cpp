@@ -0,0 +1,147 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* See feature_test_macros(7) */
+#endif
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "RingMemory.hpp"
+
+namespace iuring
+{
+namespace
+{
+    constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+    size_t base_page_size()
+    {
+        static const size_t size = [] {
+            const auto ret = sysconf(_SC_PAGESIZE);
+            return ret > 0 ? static_cast<size_t>(ret) : size_t{ 4096 };
+        }();
+        return size;
+    }
+
+    size_t round_up(size_t size, size_t multiple)
+    {
+        return (size + multiple - 1) / multiple * multiple;
+    }
+} // namespace
+
+
+RingMemory::~RingMemory()
+{
+    unmap();
+}
+
+
+void RingMemory::unmap()
+{
+    if (m_data)
+    {
+        munmap(m_data, m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+
+error::Error RingMemory::map(size_t size, const RingMemoryConfig& config)
+{
+    assert(!m_data);
+    assert(size > 0);
+
+    void* mapped = MAP_FAILED;
+    if (config.huge_pages)
+    {
+        // explicit huge pages only exist if the admin reserved some
+        m_size = round_up(size, HUGE_PAGE_SIZE);
+        mapped = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+            MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+        m_huge_pages = mapped != MAP_FAILED;
+        if (!m_huge_pages)
+        {
+            LOG_DEBUG(get_logger(), "MAP_HUGETLB({} bytes): {}, using THP",
+                m_size, strerror(errno));
+        }
+    }
+
+    if (mapped == MAP_FAILED)
+    {
+        m_size = round_up(size, config.huge_pages ? HUGE_PAGE_SIZE : base_page_size());
+        mapped = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+            MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+        if (mapped == MAP_FAILED)
+        {
+            LOG_ERROR(get_logger(), "ring memory mmap({} bytes): {}\n", m_size,
+                strerror(errno));
+            m_size = 0;
+            return error::Error::MMAP_FAILED;
+        }
+
+        if (config.huge_pages &&
+            madvise(mapped, m_size, MADV_HUGEPAGE) != 0)
+        {
+            LOG_DEBUG(get_logger(), "madvise(MADV_HUGEPAGE): {}",
+                strerror(errno));
+        }
+    }
+    m_data = static_cast<uint8_t*>(mapped);
+
+    // the policy only applies to pages faulted in after it is set
+    if (config.numa_local)
+    {
+        bind_to_local_node();
+    }
+    if (config.prefault)
+    {
+        prefault();
+    }
+    return error::Error::OK;
+}
+
+
+void RingMemory::bind_to_local_node()
+{
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+    {
+        LOG_ERROR(get_logger(), "getcpu: {}", strerror(errno));
+        return;
+    }
+
+    // MPOL_PREFERRED: falls back to other nodes instead of failing
+    // when the local node runs out of memory
+    if (node >= sizeof(unsigned long) * 8)
+    {
+        return;
+    }
+    const unsigned long nodemask = 1UL << node;
+    if (syscall(SYS_mbind, m_data, m_size, MPOL_PREFERRED, &nodemask,
+            sizeof(nodemask) * 8, 0) != 0)
+    {
+        LOG_ERROR(get_logger(), "mbind(node {}): {}", node, strerror(errno));
+        return;
+    }
+    LOG_DEBUG(get_logger(), "{} bytes of ring memory bound to node {} (cpu {})",
+        m_size, node, cpu);
+}
+
+
+void RingMemory::prefault()
+{
+    volatile uint8_t* p = m_data;
+    const auto page_size = base_page_size();
+    for (size_t offset = 0; offset < m_size; offset += page_size)
+    {
+        p[offset] = 0;
+    }
+}
+
+} // namespace iuring
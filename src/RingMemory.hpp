@@ -0,0 +1,72 @@
+#pragma once
+
+/**
+ * @file RingMemory.hpp
+ * @brief Defines RingMemory, the mmap()ed backing of buffer rings and the
+ * send arena.
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <slogger/Error.hpp>
+#include <slogger/ILogger.hpp>
+
+#include <iuring/IOUringConfig.hpp>
+
+namespace iuring
+{
+/** An anonymous mapping placed according to a RingMemoryConfig:
+ * huge pages if possible, on the NUMA node of the CPU that maps it,
+ * and faulted in before it is used.
+ */
+class RingMemory
+{
+public:
+    explicit RingMemory(logging::ILogger& logger)
+        : m_logger(logger)
+    {
+    }
+
+    RingMemory(const RingMemory&) = delete;
+    RingMemory& operator=(const RingMemory&) = delete;
+
+    ~RingMemory();
+
+    /** maps at least 'size' bytes, see size() for the actual size */
+    error::Error map(size_t size, const RingMemoryConfig& config);
+
+    void unmap();
+
+    uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    bool uses_huge_pages() const
+    {
+        return m_huge_pages;
+    }
+
+private:
+    logging::ILogger& m_logger;
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_huge_pages = false;
+
+    logging::ILogger& get_logger()
+    {
+        return m_logger;
+    }
+
+    void bind_to_local_node();
+    void prefault();
+};
+
+} // namespace iuring
@@ -0,0 +1,50 @@
+#include "SendArena.hpp"
+
+namespace iuring
+{
+error::Error SendArena::init(
+    size_t slots, size_t slot_size, const RingMemoryConfig& memory)
+{
+    assert(!m_base);
+    assert(slots > 0 && slot_size > 0);
+
+    if (auto ret = m_memory.map(slots * slot_size, memory);
+        ret != error::Error::OK)
+    {
+        return ret;
+    }
+
+    m_base = m_memory.data();
+    m_slots = slots;
+    m_slot_size = slot_size;
+
+    m_free_slots.clear();
+    m_free_slots.reserve(slots);
+    for (size_t i = slots; i > 0; i--)
+    {
+        m_free_slots.push_back(static_cast<unsigned>(i - 1));
+    }
+    return error::Error::OK;
+}
+
+
+std::optional<unsigned> SendArena::alloc()
+{
+    if (m_free_slots.empty())
+    {
+        return std::nullopt;
+    }
+    const auto slot = m_free_slots.back();
+    m_free_slots.pop_back();
+    return slot;
+}
+
+
+void SendArena::release(unsigned slot)
+{
+    assert(slot < m_slots);
+    assert(m_free_slots.size() < m_slots);
+    m_free_slots.push_back(slot);
+}
+
+} // namespace iuring
@@ -0,0 +1,82 @@
+#pragma once
+
+/**
+ * @file SendArena.hpp
+ * @brief Defines the SendArena, the pre-faulted memory that send packets
+ * are built in.
+ */
+
+#include <sys/uio.h>
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <slogger/Error.hpp>
+#include <slogger/ILogger.hpp>
+
+#include "RingMemory.hpp"
+
+namespace iuring
+{
+/** One RingMemory region cut in equally sized slots, one per send in flight.
+ * The ring registers the region with io_uring_register_buffers() so that
+ * the kernel pins it once, instead of on every send.
+ */
+class SendArena
+{
+public:
+    explicit SendArena(logging::ILogger& logger)
+        : m_memory(logger)
+    {
+    }
+
+    SendArena(const SendArena&) = delete;
+    SendArena& operator=(const SendArena&) = delete;
+
+    /** maps slots * slot_size bytes */
+    error::Error init(
+        size_t slots, size_t slot_size, const RingMemoryConfig& memory = {});
+
+    bool is_initialized() const
+    {
+        return m_base != nullptr;
+    }
+
+    /** the whole region, for io_uring_register_buffers() */
+    iovec get_iovec() const
+    {
+        return iovec{ .iov_base = m_base, .iov_len = m_memory.size() };
+    }
+
+    size_t slot_size() const
+    {
+        return m_slot_size;
+    }
+
+    size_t available() const
+    {
+        return m_free_slots.size();
+    }
+
+    /** @return std::nullopt if every slot is in use */
+    std::optional<unsigned> alloc();
+
+    void release(unsigned slot);
+
+    uint8_t* get_slot(unsigned slot)
+    {
+        assert(slot < m_slots);
+        return m_base + slot * m_slot_size;
+    }
+
+private:
+    RingMemory m_memory;
+    uint8_t* m_base = nullptr;
+    size_t m_slots = 0;
+    size_t m_slot_size = 0;
+    std::vector<unsigned> m_free_slots;
+};
+
+} // namespace iuring
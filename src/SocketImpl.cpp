@@ -3,7 +3,9 @@
 #include <cstring>
 
 #include <arpa/inet.h>
+#include <linux/net_tstamp.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
 #include <sys/socket.h>
 
 #include <slogger/ILogger.hpp>
@@ -23,9 +25,10 @@ std::shared_ptr<ISocket> ISocket::create_impl(
 
 
 std::shared_ptr<ISocket> ISocket::create_impl(SocketType type,
-    SocketPortID port, logging::ILogger& logger, SocketKind kind)
+    SocketPortID port, logging::ILogger& logger, SocketKind kind,
+    bool reuse_port)
 {
-    return SocketImpl::create(type, port, logger, kind);
+    return SocketImpl::create(type, port, logger, kind, reuse_port);
 }
 
 std::shared_ptr<SocketImpl> SocketImpl::create(
@@ -43,18 +46,20 @@ std::shared_ptr<SocketImpl> SocketImpl::create(
 }
 
 std::shared_ptr<SocketImpl> SocketImpl::create(SocketType type,
-    SocketPortID port, logging::ILogger& logger, SocketKind kind)
+    SocketPortID port, logging::ILogger& logger, SocketKind kind,
+    bool reuse_port)
 {
     class EnableShared : public SocketImpl
     {
     public:
         EnableShared(SocketType type, SocketPortID port,
-            logging::ILogger& logger, SocketKind kind)
-            : SocketImpl(type, port, logger, kind)
+            logging::ILogger& logger, SocketKind kind, bool reuse_port)
+            : SocketImpl(type, port, logger, kind, reuse_port)
         {
         }
     };
-    return std::make_shared<EnableShared>(type, port, logger, kind);
+    return std::make_shared<EnableShared>(
+        type, port, logger, kind, reuse_port);
 }
 
 
@@ -63,7 +68,8 @@ SocketImpl::SocketImpl(logging::ILogger& logger, const AcceptResult& new_conn)
           SocketKind::SERVER_STREAM_SOCKET, new_conn.m_new_fd)
 {
     memset(&m_mreq, 0, sizeof(m_mreq));
-    assert(get_fd() > 0);
+    set_fixed_slot(new_conn.m_fixed_slot);
+    assert(get_fd() > 0 || get_fixed_slot().has_value());
 }
 
 
@@ -110,7 +116,7 @@ namespace
 } // namespace
 
 SocketImpl::SocketImpl(SocketType type, SocketPortID port,
-    logging::ILogger& logger, SocketKind kind)
+    logging::ILogger& logger, SocketKind kind, bool reuse_port)
     : ISocket(type, port, logger, kind, create_socket(logger, type))
 {
     memset(&m_mreq, 0, sizeof(m_mreq));
@@ -154,6 +160,17 @@ SocketImpl::SocketImpl(SocketType type, SocketPortID port,
         const auto tmp_port =
             static_cast<std::underlying_type_t<SocketPortID>>(port);
 
+        // every ring of an IOUringGroup binds its own listener to the port,
+        // the kernel then spreads the incoming connections over them.
+        // Other listeners keep the port to themselves.
+        int val = 1;
+        if (reuse_port &&
+            setsockopt(get_fd(), SOL_SOCKET, SO_REUSEPORT, &val, sizeof(val)))
+        {
+            perror("setsockopt SO_REUSEPORT failed");
+            abort();
+        }
+
         sockaddr_in server_addr{};
         server_addr.sin_family = AF_INET;
         server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
@@ -229,6 +246,124 @@ int SocketImpl::mcast_bind()
 }
 
 
+error::Error SocketImpl::enable_receive_control(ReceiveControl control)
+{
+    assert(get_fd() >= 0);
+    assert(!is_stream());
+
+    [[maybe_unused]] int on = 1;
+    int ret = -1;
+    switch (control)
+    {
+    case ReceiveControl::GRO:
+#ifdef UDP_GRO
+        ret = setsockopt(get_fd(), SOL_UDP, UDP_GRO, &on, sizeof(on));
+#else
+        errno = EOPNOTSUPP;
+#endif
+        break;
+
+    case ReceiveControl::TIMESTAMP:
+        ret = add_timestamping_flags(
+            SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE);
+        break;
+
+    case ReceiveControl::PACKET_INFO:
+        ret = is_ipv6()
+            ? setsockopt(get_fd(), SOL_IPV6, IPV6_RECVPKTINFO, &on, sizeof(on))
+            : setsockopt(get_fd(), SOL_IP, IP_PKTINFO, &on, sizeof(on));
+        break;
+
+    case ReceiveControl::TOS:
+        ret = is_ipv6()
+            ? setsockopt(get_fd(), SOL_IPV6, IPV6_RECVTCLASS, &on, sizeof(on))
+            : setsockopt(get_fd(), SOL_IP, IP_RECVTOS, &on, sizeof(on));
+        break;
+
+    case ReceiveControl::TTL:
+        ret = is_ipv6()
+            ? setsockopt(get_fd(), SOL_IPV6, IPV6_RECVHOPLIMIT, &on, sizeof(on))
+            : setsockopt(get_fd(), SOL_IP, IP_RECVTTL, &on, sizeof(on));
+        break;
+    }
+
+    if (ret < 0)
+    {
+        LOG_ERROR(get_logger(), "failed to enable receive control {}: {}",
+            static_cast<uint32_t>(control), strerror(errno));
+        return error::errno_to_error(errno);
+    }
+
+    add_receive_control(control);
+    return error::Error::OK;
+}
+
+
+error::Error SocketImpl::enable_tx_timestamps()
+{
+    assert(get_fd() >= 0);
+    assert(!is_stream());
+
+    // the kernel only restarts its id counter when OPT_ID is new
+    const bool had_ids = m_timestamping_flags & SOF_TIMESTAMPING_OPT_ID;
+
+    // the packets ask for TX_SOFTWARE themselves, the error queue only
+    // carries the timestamp and the id, not a copy of the packet
+    if (add_timestamping_flags(SOF_TIMESTAMPING_SOFTWARE |
+            SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY) < 0)
+    {
+        LOG_ERROR(get_logger(), "failed to enable TX timestamps: {}",
+            strerror(errno));
+        return error::errno_to_error(errno);
+    }
+    if (!had_ids)
+    {
+        reset_tx_timestamp_id();
+    }
+
+#ifdef SCM_TS_OPT_ID
+    // kernels < 6.13 reject it, the ring then falls back to counting
+    set_tx_timestamps_enabled(true);
+#else
+    set_tx_timestamps_enabled(false);
+#endif
+    return error::Error::OK;
+}
+
+
+error::Error SocketImpl::resync_tx_timestamp_ids()
+{
+    assert(m_timestamping_flags & SOF_TIMESTAMPING_OPT_ID);
+
+    // the kernel only restarts its count when OPT_ID is switched on anew
+    const uint32_t without_ids = m_timestamping_flags & ~SOF_TIMESTAMPING_OPT_ID;
+    if (setsockopt(get_fd(), SOL_SOCKET, SO_TIMESTAMPING, &without_ids,
+            sizeof(without_ids)) < 0 ||
+        setsockopt(get_fd(), SOL_SOCKET, SO_TIMESTAMPING, &m_timestamping_flags,
+            sizeof(m_timestamping_flags)) < 0)
+    {
+        LOG_ERROR(get_logger(), "failed to restart the TX timestamp ids: {}",
+            strerror(errno));
+        return error::errno_to_error(errno);
+    }
+    reset_tx_timestamp_id();
+    return error::Error::OK;
+}
+
+
+int SocketImpl::add_timestamping_flags(uint32_t flags)
+{
+    const uint32_t all = m_timestamping_flags | flags;
+    const int ret =
+        setsockopt(get_fd(), SOL_SOCKET, SO_TIMESTAMPING, &all, sizeof(all));
+    if (ret == 0)
+    {
+        m_timestamping_flags = all;
+    }
+    return ret;
+}
+
+
 void SocketImpl::join_multicast_group(
     const std::string& ip_address, const std::string& source_iface)
 {
@@ -30,11 +30,13 @@ private:
     SocketImpl(logging::ILogger& logger, const AcceptResult& new_conn);
 
     SocketImpl(
-        SocketType type, SocketPortID port, logging::ILogger& logger, SocketKind kind);
+        SocketType type, SocketPortID port, logging::ILogger& logger, SocketKind kind,
+        bool reuse_port);
 
 public:
     static std::shared_ptr<SocketImpl> create(logging::ILogger& logger, const AcceptResult& new_conn);
-    static std::shared_ptr<SocketImpl> create(SocketType type, SocketPortID port, logging::ILogger& logger, SocketKind kind);
+    static std::shared_ptr<SocketImpl> create(SocketType type, SocketPortID port, logging::ILogger& logger, SocketKind kind,
+        bool reuse_port = false);
 
     void dump_info();
 
@@ -43,14 +45,22 @@ public:
 
     int mcast_bind() override;
 
+    error::Error enable_receive_control(ReceiveControl control) override;
+
+    error::Error enable_tx_timestamps() override;
+    error::Error resync_tx_timestamp_ids() override;
+
     void join_multicast_group(const std::string& ip_address,
         const std::string& source_iface) override;
     void leave_multicast_group();
 
 private:
     ip_mreq m_mreq{};
+    /** SO_TIMESTAMPING takes all flags at once */
+    uint32_t m_timestamping_flags = 0;
 
     void local_bind(SocketPortID port_id);
+    int add_timestamping_flags(uint32_t flags);
 };
 
 } // namespace iuring
\ No newline at end of file
@@ -21,6 +21,8 @@ const char* WorkItem::type_to_string(Type t)
         return "unknown";
     case Type::CLOSE:
         return "close";
+    case Type::MSG_RING:
+        return "msg_ring";
     }
     return "<unknown type of work item>";
 }
@@ -33,6 +35,20 @@ void WorkItem::submit(const recv_callback_func_t& cb)
     m_io_ring->submit(*this);
 }
 
+void WorkItem::submit(const recv_batch_callback_func_t& cb)
+{
+    m_callback = cb;
+    m_work_type = Type::RECV;
+    m_io_ring->submit(*this);
+}
+
+void WorkItem::submit(const tx_timestamp_callback_func_t& cb)
+{
+    m_callback = cb;
+    m_work_type = Type::RECV;
+    m_io_ring->submit(*this);
+}
+
 void WorkItem::submit_packet(
     const DatagramSendParameters& params, const send_callback_func_t& cb)
 {
@@ -79,6 +95,34 @@ void WorkItem::submit(const close_callback_func_t& cb)
     m_io_ring->submit(*this);
 }
 
+
+void WorkItem::submit_ring_message(
+    int target_ring_fd, uint32_t len, uint64_t data)
+{
+    m_target_ring_fd = target_ring_fd;
+    m_ring_msg_len = len;
+    m_ring_msg_data = data;
+    m_work_type = Type::MSG_RING;
+    m_io_ring->submit(*this);
+}
+
+
+void WorkItem::submit_ring_fd_message(int target_ring_fd,
+    unsigned source_slot, unsigned target_slot, uint64_t data)
+{
+    m_ring_msg_source_slot = source_slot;
+    m_ring_msg_target_slot = target_slot;
+    submit_ring_message(target_ring_fd, 0, data);
+}
+
+
+void WorkItem::submit_close_direct(unsigned slot)
+{
+    m_close_fixed_slot = slot;
+    m_work_type = Type::CLOSE;
+    m_io_ring->submit(*this);
+}
+
 SocketType get_type(const AcceptResult& res)
 {
     if (res.m_address.get_ipv4())
@@ -5,6 +5,7 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -85,10 +86,26 @@ public:
         const send_callback_func_t& cb) override;
     /** submit a recv request */
     void submit(const recv_callback_func_t& cb);
+    /** submit a recv request that delivers all buffers of a completion */
+    void submit(const recv_batch_callback_func_t& cb);
+    /** submit a recv request on the socket's error queue */
+    void submit(const tx_timestamp_callback_func_t& cb);
     /** submit a accept request */
     void submit(const accept_callback_func_t& cb);
     /** submit a close request */
     void submit(const close_callback_func_t& cb);
+    /** post a CQE with 'len' as res and 'data' as user_data to another ring
+     */
+    void submit_ring_message(int target_ring_fd, uint32_t len, uint64_t data);
+
+    /** passes the file in 'source_slot' of our file table to 'target_slot'
+     * of the target ring's table
+     */
+    void submit_ring_fd_message(int target_ring_fd, unsigned source_slot,
+        unsigned target_slot, uint64_t data);
+
+    /** close_direct of a slot whose socket is no longer ours */
+    void submit_close_direct(unsigned slot);
 
     void clean_send_packet()
     {
@@ -109,9 +126,14 @@ public:
     {
         assert(std::holds_alternative<send_callback_func_t>(m_callback));
         auto call = std::get<send_callback_func_t>(m_callback);
-        SendResult result{ status };
+        SendResult result{ status, m_tx_timestamp_id,
+            m_tx_timestamp_generation };
         call(result);
-        m_send_packet.reset();
+        // a zero-copy send may still read the packet until its notification
+        if (!m_zero_copy_send)
+        {
+            m_send_packet.reset();
+        }
     }
 
     void call_close_callback(int status)
@@ -127,8 +149,34 @@ public:
         const ReceivedMessage& payload) const
     {
         assert(std::holds_alternative<recv_callback_func_t>(m_callback));
-        auto call = std::get<recv_callback_func_t>(m_callback);
-        return call(payload);
+        // no copy: receive work items are not handed out, so the callback
+        // can't replace itself
+        return std::get<recv_callback_func_t>(m_callback)(payload);
+    }
+
+    [[nodiscard]] ReceivePostAction call_recv_batch_callback(
+        std::span<const ReceivedMessage> msgs) const
+    {
+        assert(has_batch_callback());
+        return std::get<recv_batch_callback_func_t>(m_callback)(msgs);
+    }
+
+    bool has_batch_callback() const
+    {
+        return std::holds_alternative<recv_batch_callback_func_t>(m_callback);
+    }
+
+    /** receives from the error queue deliver TX timestamps */
+    bool is_error_queue_receive() const
+    {
+        return std::holds_alternative<tx_timestamp_callback_func_t>(
+            m_callback);
+    }
+
+    void call_tx_timestamp_callback(const TxTimestamp& timestamp) const
+    {
+        assert(is_error_queue_receive());
+        std::get<tx_timestamp_callback_func_t>(m_callback)(timestamp);
     }
 
     void call_accept_callback(const AcceptResult& new_conn) const
@@ -189,7 +237,9 @@ private:
     work_item_id_t m_id;
 
     std::variant<connect_callback_func_t, accept_callback_func_t,
-        recv_callback_func_t, send_callback_func_t, close_callback_func_t>
+        recv_callback_func_t, recv_batch_callback_func_t,
+        tx_timestamp_callback_func_t, send_callback_func_t,
+        close_callback_func_t>
         m_callback;
 
     // used/set when creating submit entry:
@@ -201,7 +251,36 @@ private:
     IPAddress m_sa;
     sockaddr_storage m_buffer_for_uring;
     socklen_t m_accept_sock_len = 0;
+    std::optional<unsigned> m_accept_fixed_slot;
+    /** the send arena slot m_send_packet is built in */
+    std::optional<unsigned> m_send_slot;
+    bool m_zero_copy_send = false;
+    /** datagram sends: the id of the TX timestamp asked for */
+    std::optional<uint32_t> m_tx_timestamp_id;
+    uint32_t m_tx_timestamp_generation = 0;
+    /** the packet carries its id (SCM_TS_OPT_ID) */
+    bool m_tx_id_per_packet = false;
+    /** receives: the buffer group to take buffers from */
+    uint16_t m_buffer_group = 0;
+    /** starved receives: BufferGroup::get_recycled() of the size class
+     * when the buffers ran out
+     */
+    unsigned m_starved_recycled = 0;
+    /** starved receives: waiting for a buffer to come back */
+    bool m_waits_for_buffer = false;
+    /** receives: armed as multishot request */
+    bool m_multishot = false;
+    /** receives: armed with IORING_RECVSEND_BUNDLE */
+    bool m_bundle = false;
     socklen_t m_connect_sock_len = 0;
+    int m_target_ring_fd = -1;
+    uint32_t m_ring_msg_len = 0;
+    uint64_t m_ring_msg_data = 0;
+    /** socket handoffs: the slots the file moves between */
+    std::optional<unsigned> m_ring_msg_source_slot;
+    std::optional<unsigned> m_ring_msg_target_slot;
+    /** submit_close_direct(): the slot to empty */
+    std::optional<unsigned> m_close_fixed_slot;
     std::string m_descr;
 
     // if the next request should wait for this one to finish
@@ -222,6 +301,7 @@ private:
     void init_send_msg();
 
     friend class IOUring;
+    friend class WorkPool;
 };
 
 SocketType get_type(const AcceptResult& res);
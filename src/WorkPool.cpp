@@ -80,11 +80,40 @@ std::shared_ptr<WorkItem> WorkPool::alloc_send_work_item(
 std::shared_ptr<WorkItem> WorkPool::alloc_recv_work_item(
     const std::shared_ptr<ISocket>& socket,
     const std::shared_ptr<iuring::IOUringInterface>& network,
-    const recv_callback_func_t& callback, const char* descr)
+    const recv_callback_func_t& callback, uint16_t buffer_group,
+    const char* descr)
+{
+    std::lock_guard lock(m_mutex);
+    auto wi = internal_alloc_work_item(socket, network, descr);
+    assert(wi);
+    wi->m_buffer_group = buffer_group;
+    wi->submit(callback);
+    return wi;
+}
+
+std::shared_ptr<WorkItem> WorkPool::alloc_recv_work_item(
+    const std::shared_ptr<ISocket>& socket,
+    const std::shared_ptr<iuring::IOUringInterface>& network,
+    const recv_batch_callback_func_t& callback, uint16_t buffer_group,
+    const char* descr)
 {
     std::lock_guard lock(m_mutex);
     auto wi = internal_alloc_work_item(socket, network, descr);
     assert(wi);
+    wi->m_buffer_group = buffer_group;
+    wi->submit(callback);
+    return wi;
+}
+
+std::shared_ptr<WorkItem> WorkPool::alloc_tx_timestamp_work_item(
+    const std::shared_ptr<ISocket>& socket,
+    const std::shared_ptr<iuring::IOUringInterface>& network,
+    const tx_timestamp_callback_func_t& callback, const char* descr)
+{
+    std::lock_guard lock(m_mutex);
+    auto wi = internal_alloc_work_item(socket, network, descr);
+    assert(wi);
+    wi->m_buffer_group = socket->get_buffer_group();
     wi->submit(callback);
     return wi;
 }
@@ -127,4 +156,43 @@ std::shared_ptr<WorkItem> WorkPool::alloc_close_work_item(
     return wi;
 }
 
+
+std::shared_ptr<WorkItem> WorkPool::alloc_ring_message_work_item(
+    const std::shared_ptr<ISocket>& socket,
+    const std::shared_ptr<iuring::IOUringInterface>& network,
+    int target_ring_fd, uint32_t len, uint64_t data, const char* descr)
+{
+    std::lock_guard lock(m_mutex);
+    auto wi = internal_alloc_work_item(socket, network, descr);
+    assert(wi);
+    wi->submit_ring_message(target_ring_fd, len, data);
+    return wi;
+}
+
+
+std::shared_ptr<WorkItem> WorkPool::alloc_ring_fd_message_work_item(
+    const std::shared_ptr<ISocket>& socket,
+    const std::shared_ptr<iuring::IOUringInterface>& network,
+    int target_ring_fd, unsigned source_slot, unsigned target_slot,
+    uint64_t data, const char* descr)
+{
+    std::lock_guard lock(m_mutex);
+    auto wi = internal_alloc_work_item(socket, network, descr);
+    assert(wi);
+    wi->submit_ring_fd_message(target_ring_fd, source_slot, target_slot, data);
+    return wi;
+}
+
+
+std::shared_ptr<WorkItem> WorkPool::alloc_close_direct_work_item(
+    const std::shared_ptr<iuring::IOUringInterface>& network, unsigned slot,
+    const char* descr)
+{
+    std::lock_guard lock(m_mutex);
+    auto wi = internal_alloc_work_item(nullptr, network, descr);
+    assert(wi);
+    wi->submit_close_direct(slot);
+    return wi;
+}
+
 } // namespace iuring
\ No newline at end of file
@@ -53,7 +53,19 @@ public:
     std::shared_ptr<WorkItem> alloc_recv_work_item(
         const std::shared_ptr<ISocket>& socket,
         const std::shared_ptr<IOUringInterface>& network,
-        const recv_callback_func_t& callback, const char* descr);
+        const recv_callback_func_t& callback, uint16_t buffer_group,
+        const char* descr);
+
+    std::shared_ptr<WorkItem> alloc_recv_work_item(
+        const std::shared_ptr<ISocket>& socket,
+        const std::shared_ptr<IOUringInterface>& network,
+        const recv_batch_callback_func_t& callback, uint16_t buffer_group,
+        const char* descr);
+
+    std::shared_ptr<WorkItem> alloc_tx_timestamp_work_item(
+        const std::shared_ptr<ISocket>& socket,
+        const std::shared_ptr<IOUringInterface>& network,
+        const tx_timestamp_callback_func_t& callback, const char* descr);
 
     std::shared_ptr<WorkItem> alloc_accept_work_item(
         const std::shared_ptr<ISocket>& socket,
@@ -72,6 +84,22 @@ public:
         const close_callback_func_t& callback, const char* descr);
 
 
+    std::shared_ptr<WorkItem> alloc_ring_message_work_item(
+        const std::shared_ptr<ISocket>& socket,
+        const std::shared_ptr<iuring::IOUringInterface>& network,
+        int target_ring_fd, uint32_t len, uint64_t data, const char* descr);
+
+    std::shared_ptr<WorkItem> alloc_ring_fd_message_work_item(
+        const std::shared_ptr<ISocket>& socket,
+        const std::shared_ptr<iuring::IOUringInterface>& network,
+        int target_ring_fd, unsigned source_slot, unsigned target_slot,
+        uint64_t data, const char* descr);
+
+    std::shared_ptr<WorkItem> alloc_close_direct_work_item(
+        const std::shared_ptr<iuring::IOUringInterface>& network,
+        unsigned slot, const char* descr);
+
+
     std::shared_ptr<WorkItem> get_work_item(work_item_id_t id);
     void free_work_item(work_item_id_t id);
 
@@ -1,3 +1,4 @@
+#include <iuring/IOUringGroup.hpp>
 #include <iuring/IOUringInterface.hpp>
 #include <iuring/ISocket.hpp>
 #include <iuring/SocketFactoryImpl.hpp>
@@ -11,7 +12,7 @@ namespace server
 {
 static void Usage()
 {
-    printf("Usage: --ping <ip>\n");
+    printf("Usage: [--no-tune] [--rings <n>]\n");
 }
 
 bool should_quit = false;
@@ -54,10 +55,55 @@ void do_echo_server(logging::ILogger& logger, const std::string& interface_name,
     LOG_INFO(logger, "waiting for new requests");
     while (!should_quit)
     {
-        io->poll_completion_queues();
+        io->run_once(100ms);
     }
     LOG_INFO(logger, "exiting...");
 }
+
+/** one ring per core, each with its own SO_REUSEPORT listener */
+void do_multi_ring_echo_server(logging::ILogger& logger,
+    const std::string& interface_name, bool tune, size_t num_rings)
+{
+    auto port = iuring::SocketPortID::LOCAL_WEB_PORT;
+
+    LOG_INFO(logger, "going to do an echo server on {} rings", num_rings);
+
+    iuring::NetworkAdapter adapter(logger, interface_name, tune);
+
+    iuring::IOUringGroupConfig config;
+    config.num_rings = num_rings;
+    config.ring_config.single_issuer = true;
+    config.ring_config.defer_taskrun = true;
+
+    iuring::IOUringGroup group(logger, adapter, config);
+    const auto ret = group.start(
+        [&logger, &group, port](size_t ring_index,
+            const std::shared_ptr<iuring::IOUringInterface>& io) {
+            auto socket =
+                group.create_listener(iuring::SocketType::IPV4_TCP, port);
+
+            io->submit_accept(socket,
+                [io, socket, &logger, ring_index](
+                    const iuring::AcceptResult& res) {
+                    LOG_INFO(logger, "ring {} accepted a connection",
+                        ring_index);
+                    handle_new_connection(res, io, logger);
+                });
+        });
+    if (ret != error::Error::OK)
+    {
+        LOG_ERROR(logger, "failed to start the rings");
+        return;
+    }
+
+    LOG_INFO(logger, "waiting for new requests");
+    while (!should_quit)
+    {
+        std::this_thread::sleep_for(100ms);
+    }
+    group.stop();
+    LOG_INFO(logger, "exiting...");
+}
 } // namespace server
 
 
@@ -67,6 +113,7 @@ int main(int argc, char** argv)
 
     const std::string interface_name = "eth0";
     bool tune = true;
+    size_t num_rings = 1;
 
     for (int i = 0; i < argc; i++)
     {
@@ -75,6 +122,10 @@ int main(int argc, char** argv)
         {
             tune = false;
         }
+        else if (arg == "--rings" && i + 1 < argc)
+        {
+            num_rings = std::stoul(argv[i + 1]);
+        }
         else if (arg == "--help")
         {
             server::Usage();
@@ -82,6 +133,13 @@ int main(int argc, char** argv)
         }
     }
 
-    server::do_echo_server(logger, interface_name, tune);
+    if (num_rings > 1)
+    {
+        server::do_multi_ring_echo_server(logger, interface_name, tune, num_rings);
+    }
+    else
+    {
+        server::do_echo_server(logger, interface_name, tune);
+    }
     return 0;
 }
\ No newline at end of file
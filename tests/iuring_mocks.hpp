@@ -24,6 +24,10 @@ public:
         (override));
 
     MOCK_METHOD(int, mcast_bind, (), (override));
+    MOCK_METHOD(error::Error, enable_receive_control,
+        (ReceiveControl control), (override));
+    MOCK_METHOD(error::Error, enable_tx_timestamps, (), (override));
+    MOCK_METHOD(error::Error, resync_tx_timestamp_ids, (), (override));
     MOCK_METHOD(void, join_multicast_group,
         (const std::string& ip_address, const std::string& source_iface),
         (override));
@@ -72,7 +76,20 @@ class IOUring : public IOUringInterface
 {
 public:
     MOCK_METHOD(error::Error, init, (), (override));
+    MOCK_METHOD(const IOUringConfig&, get_active_config, (), (const, override));
+    MOCK_METHOD(const IOUringCapabilities&, get_capabilities, (),
+        (const, override));
+    MOCK_METHOD(IOUringStats, get_stats, (), (const, override));
+    MOCK_METHOD(void, set_backpressure_handler,
+        (backpressure_callback_func_t handler), (override));
     MOCK_METHOD(error::Error, poll_completion_queues, (), (override));
+    MOCK_METHOD((std::expected<size_t, error::Error>), reap_completions,
+        (size_t budget), (override));
+    MOCK_METHOD((std::expected<size_t, error::Error>), wait_for_completions,
+        (size_t min_events, std::chrono::microseconds timeout), (override));
+    MOCK_METHOD((std::expected<size_t, error::Error>), run_once,
+        (std::chrono::microseconds timeout), (override));
+    MOCK_METHOD(error::Error, flush, (), (override));
     MOCK_METHOD(void, submit_connect,
         (const std::shared_ptr<ISocket>& socket, const IPAddress& target,
             connect_callback_func_t handler),
@@ -84,12 +101,43 @@ public:
     MOCK_METHOD(void, submit_recv,
         (const std::shared_ptr<ISocket>& socket, recv_callback_func_t handler),
         (override));
+    MOCK_METHOD(void, submit_recv,
+        (const std::shared_ptr<ISocket>& socket, recv_callback_func_t handler,
+            uint16_t buffer_group),
+        (override));
+    MOCK_METHOD(void, submit_recv_bundle,
+        (const std::shared_ptr<ISocket>& socket,
+            recv_batch_callback_func_t handler),
+        (override));
+    MOCK_METHOD(void, submit_recv_batch,
+        (const std::shared_ptr<ISocket>& socket,
+            recv_batch_callback_func_t handler),
+        (override));
+    MOCK_METHOD(error::Error, enable_tx_timestamps,
+        (const std::shared_ptr<ISocket>& socket,
+            tx_timestamp_callback_func_t handler),
+        (override));
     MOCK_METHOD(std::shared_ptr<IWorkItem>, ackuire_send_workitem,
         (const std::shared_ptr<ISocket>& socket), (override));
     MOCK_METHOD(void, submit, (IWorkItem & item), (override));
     MOCK_METHOD(void, submit_close,
         (const std::shared_ptr<ISocket>& socket, close_callback_func_t handler),
         (override));
+    MOCK_METHOD(error::Error, register_fixed_socket,
+        (const std::shared_ptr<ISocket>& socket), (override));
+
+    MOCK_METHOD(void, post_to_ring,
+        (const std::shared_ptr<IOUringInterface>& target,
+            const RingMessage& msg),
+        (override));
+    MOCK_METHOD(void, handoff_socket,
+        (const std::shared_ptr<IOUringInterface>& target,
+            const std::shared_ptr<ISocket>& socket),
+        (override));
+    MOCK_METHOD(void, set_ring_message_handler,
+        (ring_message_callback_func_t handler), (override));
+    MOCK_METHOD(void, set_socket_handoff_handler,
+        (socket_handoff_callback_func_t handler), (override));
 
     MOCK_METHOD(void, resolve_hostname,
         (const std::string& hostname,
@@ -82,7 +82,7 @@ void do_http_ping(const iuring::IPAddress& ping_addr, logging::ILogger& logger,
     while (!connection_has_been_closed)
     {
         assert(!timeout.elapsed());
-        io->poll_completion_queues();
+        io->run_once(100ms);
     }
 }
 } // namespace ping
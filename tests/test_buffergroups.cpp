@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+
+#include <iuring/IOUringConfig.hpp>
+
+namespace Tests
+{
+TEST(TestBufferGroups, test_find_buffer_group)
+{
+    iuring::IOUringConfig config;
+    config.buffer_groups = {
+        { .buffer_size = 2048, .count = 256 },
+        { .buffer_size = 256, .count = 1024 },
+        { .buffer_size = 65536, .count = 64 },
+    };
+
+    ASSERT_EQ(config.find_buffer_group(100), 1);
+    ASSERT_EQ(config.find_buffer_group(256), 1);
+    ASSERT_EQ(config.find_buffer_group(1500), 0);
+    ASSERT_EQ(config.find_buffer_group(9000), 2);
+    // nothing fits: the largest buffers
+    ASSERT_EQ(config.find_buffer_group(1 << 20), 2);
+}
+
+} // namespace Tests
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <thread>
+
+#include <iuring/ReceivedMessage.hpp>
+
+namespace Tests
+{
+TEST(TestBufferLease, test_lease_outlives_message)
+{
+    auto queue = std::make_shared<iuring::BufferLeaseQueue>(1);
+    const std::array<uint8_t, 4> data{ 1, 2, 3, 4 };
+
+    iuring::LeasableBuffer leasable{ .m_queue = queue.get(),
+        .m_buffer = { .m_group = 2, .m_idx = 7 } };
+    std::optional<iuring::BufferLease> lease;
+    {
+        const iuring::ReceivedMessage msg(
+            data.data(), data.size(), iuring::IPAddress(), &leasable);
+        lease = msg.take_lease();
+    }
+    // what the ring does once the callback returned
+    leasable.m_hold.reset();
+    ASSERT_TRUE(leasable.m_leased);
+    ASSERT_TRUE(lease.has_value());
+    ASSERT_EQ(lease->data(), data.data());
+    ASSERT_EQ(queue->outstanding(), 1);
+
+    // released on another thread, recycled by the ring later
+    std::thread([l = std::move(*lease)]() mutable { l.release(); }).join();
+
+    std::vector<iuring::LeasedBuffer> released;
+    queue->take_released(released);
+    ASSERT_EQ(released.size(), 1);
+    ASSERT_EQ(released[0].m_group, 2);
+    ASSERT_EQ(released[0].m_idx, 7U);
+    ASSERT_EQ(queue->outstanding(), 0);
+}
+
+TEST(TestBufferLease, test_lease_limit)
+{
+    auto queue = std::make_shared<iuring::BufferLeaseQueue>(1);
+    const uint8_t byte = 0;
+
+    iuring::LeasableBuffer first{ .m_queue = queue.get(),
+        .m_buffer = { .m_group = 0, .m_idx = 0 } };
+    iuring::LeasableBuffer second{ .m_queue = queue.get(),
+        .m_buffer = { .m_group = 0, .m_idx = 1 } };
+
+    auto lease = first.lease(&byte, 1);
+    ASSERT_TRUE(lease.has_value());
+    ASSERT_FALSE(second.lease(&byte, 1));
+    ASSERT_EQ(queue->refused(), 1);
+
+    lease.reset();
+    first.m_hold.reset();
+    ASSERT_TRUE(second.lease(&byte, 1));
+}
+
+TEST(TestBufferLease, test_segments_share_buffer)
+{
+    auto queue = std::make_shared<iuring::BufferLeaseQueue>(1);
+    const std::array<uint8_t, 6> data{};
+
+    iuring::LeasableBuffer leasable{ .m_queue = queue.get(),
+        .m_buffer = { .m_group = 0, .m_idx = 3 } };
+    iuring::ReceivedMessage msg(
+        data.data(), data.size(), iuring::IPAddress(), &leasable);
+    iuring::ReceiveMetadata metadata;
+    metadata.m_gro_segment_size = 2;
+    msg.set_metadata(metadata);
+
+    // one buffer: every segment gets a lease within the limit of 1
+    std::vector<iuring::BufferLease> leases;
+    for (size_t i = 0; i < msg.get_segment_count(); i++)
+    {
+        auto lease = msg.get_segment(i).take_lease();
+        ASSERT_TRUE(lease.has_value());
+        ASSERT_EQ(lease->data(), data.data() + 2 * i);
+        leases.push_back(std::move(*lease));
+    }
+    leasable.m_hold.reset();
+    ASSERT_EQ(queue->outstanding(), 1);
+
+    std::vector<iuring::LeasedBuffer> released;
+    leases.erase(leases.begin());
+    queue->take_released(released);
+    ASSERT_TRUE(released.empty());
+
+    // back with the last one
+    leases.clear();
+    queue->take_released(released);
+    ASSERT_EQ(released.size(), 1);
+    ASSERT_EQ(released[0].m_idx, 3U);
+}
+
+} // namespace Tests
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <time.h>
+
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <netinet/udp.h>
+
+#include "../src/ControlMessages.hpp"
+
+namespace Tests
+{
+/** a control buffer as recvmsg() fills it */
+class ControlBuffer
+{
+public:
+    explicit ControlBuffer(size_t space)
+        : m_storage(space)
+    {
+        memset(&m_msg, 0, sizeof(m_msg));
+        m_msg.msg_control = m_storage.data();
+        m_msg.msg_controllen = m_storage.size();
+        m_next = CMSG_FIRSTHDR(&m_msg);
+    }
+
+    template <typename T> void add(int level, int type, const T& value)
+    {
+        ASSERT_NE(m_next, nullptr);
+        m_next->cmsg_level = level;
+        m_next->cmsg_type = type;
+        m_next->cmsg_len = CMSG_LEN(sizeof(T));
+        memcpy(CMSG_DATA(m_next), &value, sizeof(T));
+        m_used += CMSG_SPACE(sizeof(T));
+        m_next = CMSG_NXTHDR(&m_msg, m_next);
+    }
+
+    template <typename F> void for_each(F&& visit)
+    {
+        m_msg.msg_controllen = m_used;
+        for (auto* cmsg = CMSG_FIRSTHDR(&m_msg); cmsg;
+             cmsg = CMSG_NXTHDR(&m_msg, cmsg))
+        {
+            visit(*cmsg);
+        }
+    }
+
+    iuring::ReceiveMetadata parse()
+    {
+        iuring::ReceiveMetadata metadata;
+        for_each([&](const cmsghdr& cmsg) {
+            iuring::parse_control_message(cmsg, metadata);
+        });
+        return metadata;
+    }
+
+private:
+    std::vector<uint8_t> m_storage;
+    msghdr m_msg;
+    cmsghdr* m_next;
+    size_t m_used = 0;
+};
+
+
+TEST(TestControlMessages, test_gro_segments)
+{
+    const auto space = iuring::receive_control_space(
+        static_cast<uint32_t>(iuring::ReceiveControl::GRO));
+    ASSERT_GE(space, CMSG_SPACE(sizeof(int)));
+
+    ControlBuffer control(space);
+    control.add(SOL_UDP, UDP_GRO, 1200);
+    const auto metadata = control.parse();
+    ASSERT_EQ(metadata.m_gro_segment_size, 1200);
+
+    // two full datagrams and a short one
+    std::vector<uint8_t> data(2 * 1200 + 100);
+    iuring::ReceivedMessage msg(data.data(), data.size(), iuring::IPAddress());
+    msg.set_metadata(metadata);
+    ASSERT_EQ(msg.get_segment_count(), 3);
+    ASSERT_EQ(msg.get_segment(1).begin(), data.data() + 1200);
+    ASSERT_EQ(msg.get_segment(1).get_size(), 1200);
+    ASSERT_EQ(msg.get_segment(2).get_size(), 100);
+    ASSERT_EQ(msg.get_segment(2).get_segment_count(), 1);
+}
+
+TEST(TestControlMessages, test_rx_timestamp)
+{
+    const auto controls =
+        static_cast<uint32_t>(iuring::ReceiveControl::GRO) |
+        static_cast<uint32_t>(iuring::ReceiveControl::TIMESTAMP);
+    ControlBuffer control(iuring::receive_control_space(controls));
+
+    scm_timestamping ts{};
+    ts.ts[0].tv_sec = 12;
+    ts.ts[0].tv_nsec = 345;
+    control.add(SOL_UDP, UDP_GRO, 1200);
+    control.add(SOL_SOCKET, SCM_TIMESTAMPING, ts);
+
+    const auto metadata = control.parse();
+    ASSERT_EQ(metadata.m_gro_segment_size, 1200);
+    ASSERT_EQ(metadata.m_timestamp, std::chrono::nanoseconds(12'000'000'345));
+}
+
+TEST(TestControlMessages, test_packet_info)
+{
+    const auto controls =
+        static_cast<uint32_t>(iuring::ReceiveControl::PACKET_INFO) |
+        static_cast<uint32_t>(iuring::ReceiveControl::TOS) |
+        static_cast<uint32_t>(iuring::ReceiveControl::TTL);
+    ControlBuffer control(iuring::receive_control_space(controls));
+
+    in_pktinfo info{};
+    info.ipi_ifindex = 3;
+    inet_pton(AF_INET, "224.0.1.129", &info.ipi_addr);
+    control.add(SOL_IP, IP_PKTINFO, info);
+    control.add(SOL_IP, IP_TOS, uint8_t{ 0xb8 });
+    control.add(SOL_IP, IP_TTL, 16);
+
+    const auto metadata = control.parse();
+    ASSERT_TRUE(metadata.m_destination.has_value());
+    ASSERT_EQ(metadata.m_destination->get_ipv4()->sin_addr.s_addr,
+        info.ipi_addr.s_addr);
+    ASSERT_EQ(metadata.m_interface_index, 3u);
+    ASSERT_EQ(metadata.m_tos, 0xb8);
+    ASSERT_EQ(metadata.m_ttl, 16);
+}
+
+TEST(TestControlMessages, test_tx_timestamp)
+{
+    ControlBuffer control(iuring::error_queue_control_space());
+
+    scm_timestamping ts{};
+    ts.ts[0].tv_sec = 1;
+    ts.ts[0].tv_nsec = 2;
+    sock_extended_err err{};
+    err.ee_errno = ENOMSG;
+    err.ee_origin = SO_EE_ORIGIN_TIMESTAMPING;
+    err.ee_data = 7;
+    control.add(SOL_SOCKET, SCM_TIMESTAMPING, ts);
+    control.add(SOL_IP, IP_RECVERR, err);
+
+    iuring::TxTimestampParts parts;
+    control.for_each([&](const cmsghdr& cmsg) {
+        iuring::parse_error_queue_message(cmsg, parts);
+    });
+    ASSERT_EQ(parts.m_id, 7);
+    ASSERT_EQ(parts.m_timestamp, std::chrono::nanoseconds(1'000'000'002));
+}
+
+TEST(TestControlMessages, test_no_controls)
+{
+    ASSERT_EQ(iuring::receive_control_space(0), 0);
+
+    const uint8_t byte = 0;
+    iuring::ReceivedMessage msg(&byte, 1, iuring::IPAddress());
+    ASSERT_EQ(msg.get_segment_count(), 1);
+    ASSERT_EQ(msg.get_segment(0).begin(), &byte);
+}
+
+} // namespace Tests
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+
+#include "../src/FixedFileTable.hpp"
+
+namespace Tests
+{
+TEST(TestFixedFileTable, test_alloc_until_full)
+{
+    iuring::FixedFileTable table;
+    table.reset(3);
+    ASSERT_EQ(table.size(), 3);
+
+    ASSERT_EQ(table.alloc(), 0U);
+    ASSERT_EQ(table.alloc(), 1U);
+    ASSERT_EQ(table.alloc(), 2U);
+    ASSERT_EQ(table.in_use(), 3);
+    ASSERT_FALSE(table.alloc().has_value());
+
+    table.release(1);
+    ASSERT_EQ(table.in_use(), 2);
+    ASSERT_EQ(table.alloc(), 1U);
+}
+
+TEST(TestFixedFileTable, test_empty_table)
+{
+    iuring::FixedFileTable table;
+    ASSERT_FALSE(table.alloc().has_value());
+}
+
+} // namespace Tests
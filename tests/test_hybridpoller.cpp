@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "iuring_mocks.hpp"
+
+#include <iuring/HybridPoller.hpp>
+
+using testing::_;
+using testing::Return;
+using testing::ReturnRef;
+
+using namespace std::chrono_literals;
+
+
+namespace Tests
+{
+class TestHybridPoller : public testing::Test
+{
+public:
+    std::shared_ptr<iuring::mocks::IOUring> io =
+        std::make_shared<iuring::mocks::IOUring>();
+    iuring::IOUringConfig config;
+
+    void SetUp() override
+    {
+        config.completion_budget = 16;
+        EXPECT_CALL(*io, get_active_config())
+            .WillRepeatedly(ReturnRef(config));
+    }
+};
+
+TEST_F(TestHybridPoller, sleeps_until_first_completion)
+{
+    iuring::HybridPoller poller(io);
+
+    // nothing seen yet: don't spin, block right away
+    EXPECT_CALL(*io, reap_completions(_)).Times(0);
+    EXPECT_CALL(*io, run_once(_))
+        .WillOnce(Return(std::expected<size_t, error::Error>(0)))
+        .WillOnce(Return(std::expected<size_t, error::Error>(3)));
+
+    ASSERT_EQ(poller.run_once().value(), 0);
+    ASSERT_EQ(poller.run_once().value(), 3);
+
+    ASSERT_EQ(poller.get_stats().sleep_timeouts, 1);
+    ASSERT_EQ(poller.get_stats().sleep_wakeups, 1);
+    ASSERT_EQ(poller.get_stats().spin_hits, 0);
+}
+
+TEST_F(TestHybridPoller, spins_after_completion)
+{
+    iuring::HybridPollerConfig pc;
+    pc.initial_spin = 10s;
+    pc.max_spin = 10s;
+    iuring::HybridPoller poller(io, pc);
+
+    EXPECT_CALL(*io, run_once(_))
+        .WillOnce(Return(std::expected<size_t, error::Error>(1)));
+    EXPECT_CALL(*io, reap_completions(16))
+        .WillOnce(Return(std::expected<size_t, error::Error>(0)))
+        .WillOnce(Return(std::expected<size_t, error::Error>(2)));
+
+    ASSERT_EQ(poller.run_once().value(), 1);
+    ASSERT_EQ(poller.run_once().value(), 2);
+
+    ASSERT_EQ(poller.get_stats().sleep_wakeups, 1);
+    ASSERT_EQ(poller.get_stats().spin_hits, 1);
+
+    // back to back completions shrink the window towards min_spin
+    ASSERT_LT(poller.get_stats().spin_window, 10s);
+}
+
+TEST_F(TestHybridPoller, counts_wasted_spin)
+{
+    iuring::HybridPollerConfig pc;
+    pc.initial_spin = 200us;
+    iuring::HybridPoller poller(io, pc);
+
+    EXPECT_CALL(*io, run_once(_))
+        .WillOnce(Return(std::expected<size_t, error::Error>(1)))
+        .WillOnce(Return(std::expected<size_t, error::Error>(0)));
+    EXPECT_CALL(*io, reap_completions(_))
+        .WillRepeatedly(Return(std::expected<size_t, error::Error>(0)));
+
+    ASSERT_EQ(poller.run_once().value(), 1);
+    ASSERT_EQ(poller.run_once().value(), 0);
+
+    ASSERT_EQ(poller.get_stats().spin_hits, 0);
+    ASSERT_EQ(poller.get_stats().sleep_timeouts, 1);
+    ASSERT_GT(poller.get_stats().wasted_spin_time, 0ns);
+}
+
+} // namespace Tests
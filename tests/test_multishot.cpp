@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include "../src/MultishotTracker.hpp"
+
+using iuring::MultishotState;
+
+namespace Tests
+{
+TEST(TestMultishotTracker, test_rearm_after_last_cqe)
+{
+    iuring::MultishotTracker tracker;
+    ASSERT_TRUE(tracker.arm(7));
+    // still armed: a second request would duplicate every completion
+    ASSERT_FALSE(tracker.arm(7));
+
+    ASSERT_EQ(tracker.on_completion(7, true), MultishotState::ARMED);
+    ASSERT_EQ(tracker.get_state(7), MultishotState::ARMED);
+
+    ASSERT_EQ(tracker.on_completion(7, false), MultishotState::ARMED);
+    ASSERT_EQ(tracker.get_state(7), MultishotState::DISARMED);
+    ASSERT_TRUE(tracker.arm(7));
+}
+
+TEST(TestMultishotTracker, test_cancel)
+{
+    iuring::MultishotTracker tracker;
+    ASSERT_FALSE(tracker.cancel(3));
+
+    ASSERT_TRUE(tracker.arm(3));
+    ASSERT_TRUE(tracker.cancel(3));
+    // only one cancel is sent
+    ASSERT_FALSE(tracker.cancel(3));
+
+    ASSERT_EQ(tracker.on_completion(3, true), MultishotState::CANCELLING);
+    ASSERT_EQ(tracker.on_completion(3, false), MultishotState::CANCELLING);
+    ASSERT_EQ(tracker.size(), 0);
+    ASSERT_EQ(tracker.on_completion(3, false), MultishotState::DISARMED);
+}
+
+} // namespace Tests
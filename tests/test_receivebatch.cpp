@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include "../src/ReceiveBatch.hpp"
+
+namespace Tests
+{
+TEST(TestReceiveBatch, test_buffers_go_back_in_cqe_order)
+{
+    auto queue = std::make_shared<iuring::BufferLeaseQueue>(4);
+    const std::array<uint8_t, 8> data{};
+
+    iuring::ReceiveBatch batch;
+    // two datagrams of one incrementally filled buffer, the kernel is only
+    // done with it after the second
+    batch.add(iuring::ReceivedMessage(data.data(), 2, iuring::IPAddress()), 5,
+        false);
+    batch.add(iuring::ReceivedMessage(data.data() + 2, 2, iuring::IPAddress()),
+        5, true);
+    batch.add(iuring::ReceivedMessage(data.data() + 4, 2, iuring::IPAddress()),
+        1, true);
+    batch.add(iuring::ReceivedMessage(data.data() + 6, 2, iuring::IPAddress()),
+        3, true);
+    ASSERT_EQ(batch.size(), 4);
+
+    const auto messages = batch.prepare([&](unsigned idx) {
+        return iuring::LeasableBuffer{ .m_queue = queue.get(),
+            .m_buffer = { .m_group = 0, .m_idx = idx } };
+    });
+    ASSERT_EQ(messages.size(), 4);
+    ASSERT_EQ(messages[1].begin(), data.data() + 2);
+
+    // the callback keeps buffer 1
+    auto lease = messages[2].take_lease();
+    ASSERT_TRUE(lease.has_value());
+
+    std::vector<unsigned> recycled;
+    batch.finish([&](unsigned idx) { recycled.push_back(idx); });
+    ASSERT_EQ(recycled, (std::vector<unsigned>{ 5, 3 }));
+    ASSERT_TRUE(batch.empty());
+}
+
+} // namespace Tests
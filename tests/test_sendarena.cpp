@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+
+#include "../src/SendArena.hpp"
+
+#include <slogger/Logger.hpp>
+
+namespace Tests
+{
+TEST(TestSendArena, test_alloc_release)
+{
+    logging::DirectConsoleLogger logger{ true, true,
+        logging::LogOutput::CONSOLE };
+    iuring::SendArena arena(logger);
+    ASSERT_EQ(arena.init(2, 4096), error::Error::OK);
+    ASSERT_EQ(arena.get_iovec().iov_len, 2 * 4096);
+
+    const auto a = arena.alloc();
+    const auto b = arena.alloc();
+    ASSERT_TRUE(a.has_value());
+    ASSERT_TRUE(b.has_value());
+    ASSERT_FALSE(arena.alloc().has_value());
+    ASSERT_EQ(arena.get_slot(*b) - arena.get_slot(*a), 4096);
+
+    // the slots are usable memory
+    arena.get_slot(*b)[4095] = 1;
+
+    arena.release(*a);
+    ASSERT_EQ(arena.available(), 1);
+    ASSERT_EQ(arena.alloc(), a);
+}
+
+} // namespace Tests
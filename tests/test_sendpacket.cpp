@@ -33,4 +33,24 @@ namespace Tests
 
         ASSERT_EQ(sp.to_string(), "abcdefg");
     }
+
+    TEST(TestSendPacket, test_external_storage)
+    {
+        std::array<uint8_t, 16> storage{};
+        iuring::SendPacket sp;
+        sp.append("x");
+        ASSERT_FALSE(sp.has_external_storage());
+
+        sp.attach_storage(storage.data(), storage.size());
+        ASSERT_EQ(sp.size(), 0);
+        ASSERT_EQ(sp.capacity(), storage.size());
+
+        sp.append("hello");
+        ASSERT_EQ(sp.data(), storage.data());
+        ASSERT_EQ(sp.to_string(), "hello");
+
+        sp.detach_storage();
+        ASSERT_FALSE(sp.has_external_storage());
+        ASSERT_EQ(sp.size(), 0);
+    }
 }
\ No newline at end of file
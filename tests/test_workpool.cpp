@@ -128,4 +128,18 @@ TEST_F(TestWorkPool, test_wp_connect)
     ASSERT_EQ(item->get_type_str(), std::string("connect"));
 }
 
+TEST(TestAcceptAddress, test_address_from_storage)
+{
+    // what accept() or getpeername() fill in for a new connection
+    sockaddr_storage storage{};
+    auto* sa = (sockaddr_in*) &storage;
+    sa->sin_family = AF_INET;
+    sa->sin_port = htons(4000);
+
+    const iuring::IPAddress addr(storage, sizeof(sockaddr_in));
+    ASSERT_TRUE(addr.get_ipv4());
+    ASSERT_FALSE(addr.get_ipv6());
+    ASSERT_EQ(addr.get_port(), static_cast<iuring::SocketPortID>(4000));
+}
+
 } // namespace Tests
\ No newline at end of file